@@ -0,0 +1,445 @@
+/*
+ * Benchmark of xptlib reader and writer APIs on synthetic XPT (v5) files
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++20 -O2 -I. bench/xpt_bench.cpp -o xpt_bench -pthread
+ *
+ * Usage:
+ *   xpt_bench [--rows N] [--numeric N] [--strings N] [--width N] [--batch N] [--threads N] [--repeat N] [--file PATH] [--keep]
+ */
+
+#include "xptlib.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+namespace {
+
+	// parameters of the synthetic file and the benchmark run
+	struct Bench_Config {
+		size_t rows = 1000000;
+		size_t numeric_columns = 8;
+		size_t string_columns = 4;
+		size_t string_width = 16;
+		size_t batch_rows = 65536;
+		size_t threads = 0;
+		size_t repeat = 3;
+		std::filesystem::path file = std::filesystem::temp_directory_path() / "xptlib_bench.xpt";
+		bool keep = false;
+	};
+
+	/**
+	 * Generator of synthetic XPT v5 files
+	 */
+	class Synthetic_Generator {
+		private:
+			const Bench_Config& mConfig;
+
+		public:
+			Synthetic_Generator(const Bench_Config& config) : mConfig(config) {
+			}
+
+			bool Generate() {
+				xpt::Writer writer;
+				if (!writer.Open(mConfig.file)) {
+					return false;
+				}
+
+				// numeric columns first, then string columns
+				std::vector<xpt::Variable_Definition> variables;
+				for (size_t i = 0; i < mConfig.numeric_columns; i++) {
+					const std::string name = "N" + std::to_string(i);
+					variables.push_back({ name, "Column " + name, xpt::NVar_Type::Numeric, 8 });
+				}
+				for (size_t i = 0; i < mConfig.string_columns; i++) {
+					const std::string name = "S" + std::to_string(i);
+					variables.push_back({ name, "Column " + name, xpt::NVar_Type::String, mConfig.string_width });
+				}
+
+				if (writer.Write_Headers("BENCH", variables, "Synthetic benchmark dataset") != xpt::NStatus::Ok) {
+					return false;
+				}
+
+				std::mt19937_64 rng(12345);
+				std::uniform_real_distribution<double> values(-1e6, 1e6);
+				static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+				xpt::Column_Batch batch;
+				batch.columns.resize(variables.size());
+				for (size_t i = 0; i < variables.size(); i++) {
+					batch.columns[i].variable = i;
+					batch.columns[i].type = variables[i].type;
+				}
+
+				for (size_t first = 0; first < mConfig.rows; first += mConfig.batch_rows) {
+					batch.rows = std::min(mConfig.batch_rows, mConfig.rows - first);
+
+					for (auto& col : batch.columns) {
+						col.numbers.clear();
+						col.offsets.assign(1, 0);
+						col.bytes.clear();
+
+						for (size_t r = 0; r < batch.rows; r++) {
+							if (col.type == xpt::NVar_Type::Numeric) {
+								col.numbers.push_back(values(rng));
+							}
+							else {
+								// strings of variable length (padded by blanks when written)
+								const size_t len = 1 + rng() % mConfig.string_width;
+								for (size_t j = 0; j < len; j++) {
+									col.bytes.push_back(alphabet[rng() % alphabet.size()]);
+								}
+								col.offsets.push_back(static_cast<uint32_t>(col.bytes.size()));
+							}
+						}
+					}
+
+					if (!writer.Write_Batch(batch)) {
+						return false;
+					}
+				}
+
+				return writer.Close();
+			}
+	};
+
+	// runs the benchmark function repeatedly and reports the best throughput; the function returns the count of processed items
+	// (rows by default), and bytes is the count of bytes processed by a single run (the whole file by default)
+	void Run(const Bench_Config& config, std::string_view name, const std::function<size_t()>& fn, std::string_view unit = "rows", double bytes = -1) {
+		if (bytes < 0) {
+			bytes = static_cast<double>(std::filesystem::file_size(config.file));
+		}
+
+		double best = 0;
+		size_t items = 0;
+		for (size_t i = 0; i < config.repeat; i++) {
+			const auto start = std::chrono::steady_clock::now();
+			items = fn();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (best == 0 || elapsed.count() < best) {
+				best = elapsed.count();
+			}
+		}
+
+		const std::string unit_str{ unit };
+		std::printf("%-34s %10zu %-6s %14.0f %6s/s %10.1f MB/s\n", std::string{ name }.c_str(), items, unit_str.c_str(),
+			static_cast<double>(items) / best, unit_str.c_str(), bytes / best / 1e6);
+	}
+
+	// opens the benchmark file and reads its headers
+	bool Open(xpt::File& file, const Bench_Config& config, bool mapped = false) {
+		const bool opened = mapped ? file.Open_Mapped(config.file) : file.Open(config.file);
+		return opened && file.Read_Headers() == xpt::NStatus::Ok;
+	}
+
+	struct Bound_Row {
+		double number;
+		std::string_view text;
+	};
+
+	void Run_All(const Bench_Config& config) {
+
+		Run(config, "Open + Read_Headers", [&config]() -> size_t {
+			size_t opened = 0;
+			for (size_t i = 0; i < 1000; i++) {
+				xpt::File file;
+				opened += Open(file, config) ? 1 : 0;
+			}
+			return opened;
+		}, "opens", 0);
+
+		Run(config, "Open + Read_Metadata", [&config]() -> size_t {
+			xpt::Metadata metadata;
+			size_t opened = 0;
+			for (size_t i = 0; i < 1000; i++) {
+				xpt::File file;
+				opened += (file.Open(config.file) && file.Read_Metadata(metadata) == xpt::NStatus::Ok) ? 1 : 0;
+			}
+			return opened;
+		}, "opens", 0);
+
+		Run(config, "Read_Next(vector<TValue>)", [&config]() -> size_t {
+			xpt::File file;
+			std::vector<xpt::TValue> values;
+			size_t rows = 0;
+			for (Open(file, config); file.Read_Next(values); rows++);
+			return rows;
+		});
+
+		Run(config, "Read_Next(vector<TValue_View>)", [&config]() -> size_t {
+			xpt::File file;
+			std::vector<xpt::TValue_View> values;
+			size_t rows = 0;
+			for (Open(file, config); file.Read_Next(values); rows++);
+			return rows;
+		});
+
+		Run(config, "Read_Rows(Row_Block)", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Row_Block block;
+			size_t rows = 0;
+			for (Open(file, config); file.Read_Rows(config.batch_rows, block) > 0; block.Clear()) {
+				rows += block.rows;
+			}
+			return rows;
+		});
+
+		Run(config, "Read_Arrow_Batch", [&config]() -> size_t {
+			xpt::File file;
+			ArrowArray array;
+			size_t rows = 0;
+			for (Open(file, config); file.Read_Arrow_Batch(config.batch_rows, &array) > 0; array.release(&array)) {
+				rows += static_cast<size_t>(array.length);
+			}
+			return rows;
+		});
+
+		if (config.numeric_columns > 0 && config.string_columns > 0) {
+			Run(config, "Read_Next(double, string_view)", [&config]() -> size_t {
+				xpt::File file;
+				Open(file, config);
+				file.Select({ "N0", "S0" });
+
+				double number;
+				std::string_view text;
+				size_t rows = 0;
+				for (; file.Read_Next(number, text); rows++);
+				return rows;
+			});
+
+			Run(config, "Row_Binding", [&config]() -> size_t {
+				xpt::File file;
+				Open(file, config);
+
+				xpt::Row_Binding binding{ xpt::Field{ "N0", &Bound_Row::number }, xpt::Field{ "S0", &Bound_Row::text } };
+				binding.Bind(file);
+
+				Bound_Row row;
+				size_t rows = 0;
+				for (; binding.Read_Next(row); rows++);
+				return rows;
+			});
+
+			Run(config, "Aggregate(N0) (mapped)", [&config]() -> size_t {
+				xpt::File file;
+				Open(file, config, true);
+
+				std::vector<xpt::Column_Stats> stats;
+				file.Aggregate({ { "N0", 16, 0.0, 1.0 } }, stats, 0, config.batch_rows);
+				return stats.empty() ? 0 : stats[0].count + stats[0].missing_count;
+			});
+
+			// throughput is reported in rows scanned, not in rows meeting the filter
+			Run(config, "Read_Next(vector<TValue>) filtered", [&config]() -> size_t {
+				xpt::File file;
+				Open(file, config);
+				file.Set_Filter({ { "N0", xpt::NCompare::Greater, 0.9 }, { "S0", xpt::NCompare::Starts_With, "A" } });
+
+				std::vector<xpt::TValue> values;
+				while (file.Read_Next(values));
+				return file.Row_Count().value_or(0);
+			});
+		}
+
+		Run(config, "Read_Batch", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			size_t rows = 0;
+			for (Open(file, config); file.Read_Batch(config.batch_rows, batch) > 0; rows += batch.rows);
+			return rows;
+		});
+
+		Run(config, "Read_Batch (mapped)", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			size_t rows = 0;
+			for (Open(file, config, true); file.Read_Batch(config.batch_rows, batch) > 0; rows += batch.rows);
+			return rows;
+		});
+
+		Run(config, "Read_Batch (mapped, lazy strings)", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			size_t rows = 0;
+			Open(file, config, true);
+			file.Set_Lazy_Strings(true);
+			for (; file.Read_Batch(config.batch_rows, batch) > 0; rows += batch.rows);
+			return rows;
+		});
+
+		// the synthetic strings are random, so this is the worst case of the dictionary (all values distinct)
+		Run(config, "Read_Batch (mapped, dictionary)", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			size_t rows = 0;
+			Open(file, config, true);
+
+			std::vector<std::string> names;
+			for (const auto& var : file.Get_Variable_Vector()) {
+				if (var.type == xpt::NVar_Type::String) {
+					names.push_back(var.name);
+				}
+			}
+			file.Set_Dictionary_Encoding(names);
+
+			for (; file.Read_Batch(config.batch_rows, batch) > 0; rows += batch.rows);
+			return rows;
+		});
+
+		Run(config, "Read_Batch (prefetched)", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			size_t rows = 0;
+			if (!file.Open_Prefetched(config.file) || file.Read_Headers() != xpt::NStatus::Ok) {
+				return 0;
+			}
+			for (; file.Read_Batch(config.batch_rows, batch) > 0; rows += batch.rows);
+			return rows;
+		});
+
+		Run(config, "Parallel_For_Each_Batch (mapped)", [&config]() -> size_t {
+			xpt::File file;
+			Open(file, config, true);
+
+			std::atomic<size_t> rows = 0;
+			file.Parallel_For_Each_Batch(config.threads, config.batch_rows, [&rows](const xpt::Column_Batch& batch, size_t) {
+				rows += batch.rows;
+			});
+			return rows;
+		});
+
+		Run(config, "Write_Batch", [&config]() -> size_t {
+			xpt::File file;
+			xpt::Column_Batch batch;
+			Open(file, config);
+			if (file.Read_Batch(config.batch_rows, batch) == 0) {
+				return 0;
+			}
+
+			// the first batch of the file, written repeatedly to a new file of the same size
+			std::vector<xpt::Variable_Definition> variables;
+			for (const auto& var : file.Get_Variable_Vector()) {
+				variables.push_back({ var.name, var.label, var.type, var.length });
+			}
+
+			const auto path = std::filesystem::path{ config.file }.concat(".out");
+			size_t rows = 0;
+			{
+				xpt::Writer writer;
+				writer.Open(path);
+				writer.Write_Headers("BENCH", variables);
+				while (rows < config.rows) {
+					batch.rows = std::min(batch.rows, config.rows - rows);
+					writer.Write_Batch(batch);
+					rows += batch.rows;
+				}
+			}
+
+			std::filesystem::remove(path);
+			return rows;
+		});
+
+		// conversion kernels alone, on the numeric values of the file
+		std::vector<uint64_t> raw(config.rows * std::max<size_t>(config.numeric_columns, 1));
+		std::mt19937_64 rng(54321);
+		for (auto& v : raw) {
+			v = rng();
+		}
+		std::vector<double> converted(raw.size());
+
+		const double raw_bytes = static_cast<double>(raw.size() * sizeof(uint64_t));
+
+		Run(config, "IbmToIEEE (scalar)", [&]() -> size_t {
+			xpt::internal::IbmToIEEE_Scalar(raw.data(), converted.data(), raw.size());
+			return raw.size();
+		}, "values", raw_bytes);
+
+		Run(config, "IbmToIEEE (bulk)", [&]() -> size_t {
+			xpt::internal::IbmToIEEE(raw.data(), converted.data(), raw.size());
+			return raw.size();
+		}, "values", raw_bytes);
+
+		Run(config, "IEEEToIbm (scalar)", [&]() -> size_t {
+			xpt::internal::IEEEToIbm_Scalar(converted.data(), raw.data(), raw.size());
+			return raw.size();
+		}, "values", raw_bytes);
+
+		Run(config, "IEEEToIbm (bulk)", [&]() -> size_t {
+			xpt::internal::IEEEToIbm(converted.data(), raw.data(), raw.size());
+			return raw.size();
+		}, "values", raw_bytes);
+	}
+
+	bool Parse_Arguments(int argc, char** argv, Bench_Config& config) {
+		for (int i = 1; i < argc; i++) {
+			const std::string_view arg = argv[i];
+			const bool has_value = i + 1 < argc;
+
+			auto number = [&]() {
+				return static_cast<size_t>(std::stoull(argv[++i]));
+			};
+
+			if (arg == "--rows" && has_value) {
+				config.rows = number();
+			}
+			else if (arg == "--numeric" && has_value) {
+				config.numeric_columns = number();
+			}
+			else if (arg == "--strings" && has_value) {
+				config.string_columns = number();
+			}
+			else if (arg == "--width" && has_value) {
+				config.string_width = std::max<size_t>(number(), 1);
+			}
+			else if (arg == "--batch" && has_value) {
+				config.batch_rows = std::max<size_t>(number(), 1);
+			}
+			else if (arg == "--threads" && has_value) {
+				config.threads = number();
+			}
+			else if (arg == "--repeat" && has_value) {
+				config.repeat = std::max<size_t>(number(), 1);
+			}
+			else if (arg == "--file" && has_value) {
+				config.file = argv[++i];
+			}
+			else if (arg == "--keep") {
+				config.keep = true;
+			}
+			else {
+				return false;
+			}
+		}
+
+		return config.numeric_columns + config.string_columns > 0;
+	}
+}
+
+int main(int argc, char** argv) {
+
+	Bench_Config config;
+	if (!Parse_Arguments(argc, argv, config)) {
+		std::cerr << "Usage: " << argv[0] << " [--rows N] [--numeric N] [--strings N] [--width N] [--batch N] [--threads N] [--repeat N] [--file PATH] [--keep]" << std::endl;
+		return 1;
+	}
+
+	Synthetic_Generator generator(config);
+	if (!generator.Generate()) {
+		std::cerr << "Could not generate the file " << config.file << std::endl;
+		return 2;
+	}
+
+	std::cout << "File: " << config.file << " (" << std::filesystem::file_size(config.file) << " bytes, " << config.rows << " rows, "
+		<< config.numeric_columns << " numeric and " << config.string_columns << " string columns of width " << config.string_width << ")" << std::endl;
+
+	Run_All(config);
+
+	if (!config.keep) {
+		std::filesystem::remove(config.file);
+	}
+
+	return 0;
+}
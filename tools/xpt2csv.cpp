@@ -0,0 +1,302 @@
+/*
+ * Converter of XPT files to CSV, built on the batch reader of xptlib
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++20 -O2 -I. tools/xpt2csv.cpp -o xpt2csv -pthread
+ *
+ * Usage:
+ *   xpt2csv [--columns A,B,...] [--delimiter C] [--threads N] [--batch N] [--output DIR] FILE...
+ *
+ * Every input file is converted to a CSV file of the same name with the .csv extension, placed in the output directory
+ * (the directory of the input by default). Missing numeric values are written as empty fields. The files are converted
+ * in parallel, and the threads left over are used to convert blocks of rows of a single file in parallel
+ */
+
+#include "xptlib.h"
+
+#include <charconv>
+#include <cstdio>
+#include <map>
+
+namespace {
+
+	// parameters of the conversion
+	struct Convert_Config {
+		std::vector<std::string> columns;					// selected columns, all of them if empty
+		char delimiter = ',';
+		size_t threads = 0;									// 0 for the hardware concurrency
+		size_t batch_rows = 65536;
+		std::filesystem::path output_dir;					// directory of the input if empty
+		std::vector<std::filesystem::path> inputs;
+	};
+
+	// size of the output buffer, which is written to the file once exceeded
+	constexpr size_t Flush_Size = 4 << 20;
+
+	/**
+	 * Formatter of columnar batches to CSV text
+	 */
+	class CSV_Formatter {
+		private:
+			char mDelimiter;
+
+			// appends a string field; it is quoted only if it contains the delimiter, quotes or line breaks
+			void Append_String(std::string& out, std::string_view value) const {
+				const bool quote = std::any_of(value.begin(), value.end(), [this](char c) {
+					return c == mDelimiter || c == '"' || c == '\n' || c == '\r';
+				});
+
+				if (!quote) {
+					out.append(value);
+					return;
+				}
+
+				out.push_back('"');
+				for (const char c : value) {
+					if (c == '"') {
+						out.push_back('"');
+					}
+					out.push_back(c);
+				}
+				out.push_back('"');
+			}
+
+			// appends a numeric field, using the shortest representation which round-trips; missing values are left empty
+			static void Append_Number(std::string& out, double value, bool missing) {
+				if (missing) {
+					return;
+				}
+
+				char buffer[32];
+				const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+				out.append(buffer, result.ptr);
+			}
+
+		public:
+			CSV_Formatter(char delimiter) : mDelimiter(delimiter) {
+			}
+
+			// appends the header line with the names of the selected variables
+			void Append_Header(std::string& out, const xpt::File& file) const {
+				const auto& variables = file.Get_Variable_Vector();
+				const auto& selection = file.Get_Selection();
+
+				for (size_t i = 0; i < selection.size(); i++) {
+					if (i != 0) {
+						out.push_back(mDelimiter);
+					}
+					Append_String(out, variables[selection[i]].name);
+				}
+				out.push_back('\n');
+			}
+
+			// appends all rows of the batch
+			void Append_Batch(std::string& out, const xpt::Column_Batch& batch) const {
+				for (size_t row = 0; row < batch.rows; row++) {
+					for (size_t i = 0; i < batch.columns.size(); i++) {
+						const auto& col = batch.columns[i];
+						if (i != 0) {
+							out.push_back(mDelimiter);
+						}
+
+						if (col.type == xpt::NVar_Type::Numeric) {
+							Append_Number(out, col.numbers[row], col.Is_Missing(row));
+						}
+						else {
+							Append_String(out, col.String(row));
+						}
+					}
+					out.push_back('\n');
+				}
+			}
+	};
+
+	// writes the buffer to the output and clears it
+	bool Flush(std::FILE* output, std::string& buffer) {
+		const bool written = std::fwrite(buffer.data(), 1, buffer.size(), output) == buffer.size();
+		buffer.clear();
+		return written;
+	}
+
+	/**
+	 * Converts a single file using a given count of threads; returns an empty string on success, or the error message
+	 */
+	std::string Convert_File(const Convert_Config& config, const std::filesystem::path& input, size_t threads) {
+
+		xpt::File file;
+		if (!file.Open_Mapped(input) && !file.Open(input)) {
+			return "cannot open the file";
+		}
+		if (file.Read_Headers() != xpt::NStatus::Ok) {
+			return "not a valid XPT file";
+		}
+		if (!config.columns.empty() && file.Select(config.columns) != xpt::NStatus::Ok) {
+			return "no such column";
+		}
+
+		// the strings are formatted right away, so they do not need to be copied from the file data
+		file.Set_Lazy_Strings(true);
+
+		auto output_path = config.output_dir.empty() ? input : config.output_dir / input.filename();
+		output_path.replace_extension(".csv");
+
+		std::unique_ptr<std::FILE, decltype(&std::fclose)> output{ std::fopen(output_path.string().c_str(), "wb"), &std::fclose };
+		if (!output) {
+			return "cannot create " + output_path.string();
+		}
+		// the output is buffered by the converter in large blocks
+		std::setvbuf(output.get(), nullptr, _IONBF, 0);
+
+		const CSV_Formatter formatter(config.delimiter);
+		std::string buffer;
+		buffer.reserve(Flush_Size * 2);
+
+		formatter.Append_Header(buffer, file);
+		bool written = Flush(output.get(), buffer);
+
+		// the blocks are formatted concurrently, and written in the order of their indices; a block finished ahead of its turn
+		// is left to the worker writing the preceding ones, so no worker waits for another (even if a block is short, or fails)
+		bool parallel = false;
+		if (threads > 1) {
+			std::mutex mutex;
+			std::map<size_t, std::string> pending;
+			size_t next_block = 0;
+
+			parallel = file.Parallel_For_Each_Batch(threads, config.batch_rows, [&](const xpt::Column_Batch& batch, size_t first_row) {
+				std::string block;
+				formatter.Append_Batch(block, batch);
+
+				std::lock_guard lock(mutex);
+				pending.emplace(first_row / config.batch_rows, std::move(block));
+				for (auto itr = pending.begin(); itr != pending.end() && itr->first == next_block; itr = pending.erase(itr), next_block++) {
+					written = Flush(output.get(), itr->second) && written;
+				}
+			});
+		}
+
+		if (!parallel) {
+			xpt::Column_Batch batch;
+			while (file.Read_Batch(config.batch_rows, batch) > 0) {
+				formatter.Append_Batch(buffer, batch);
+				if (buffer.size() >= Flush_Size) {
+					written = Flush(output.get(), buffer) && written;
+				}
+			}
+			written = Flush(output.get(), buffer) && written;
+		}
+
+		if (std::fflush(output.get()) != 0 || !written) {
+			return "cannot write " + output_path.string();
+		}
+
+		return {};
+	}
+
+	// splits the comma-separated list of column names
+	std::vector<std::string> Split_Columns(std::string_view list) {
+		std::vector<std::string> columns;
+		while (!list.empty()) {
+			const size_t comma = std::min(list.find(','), list.size());
+			if (comma != 0) {
+				columns.emplace_back(list.substr(0, comma));
+			}
+			list.remove_prefix(std::min(comma + 1, list.size()));
+		}
+		return columns;
+	}
+
+	bool Parse_Arguments(int argc, char** argv, Convert_Config& config) {
+		for (int i = 1; i < argc; i++) {
+			const std::string_view arg = argv[i];
+			const bool has_value = i + 1 < argc;
+
+			// parses a count, failing on anything but digits
+			auto number = [&](size_t& value) {
+				const std::string_view text = argv[++i];
+				const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+				return !text.empty() && result.ec == std::errc{} && result.ptr == text.data() + text.size();
+			};
+
+			if (arg == "--columns" && has_value) {
+				config.columns = Split_Columns(argv[++i]);
+			}
+			else if (arg == "--delimiter" && has_value) {
+				const std::string_view delimiter = argv[++i];
+				if (delimiter.size() != 1) {
+					return false;
+				}
+				config.delimiter = delimiter[0];
+			}
+			else if (arg == "--threads" && has_value) {
+				if (!number(config.threads)) {
+					return false;
+				}
+			}
+			else if (arg == "--batch" && has_value) {
+				if (!number(config.batch_rows)) {
+					return false;
+				}
+				config.batch_rows = std::max<size_t>(config.batch_rows, 1);
+			}
+			else if (arg == "--output" && has_value) {
+				config.output_dir = argv[++i];
+			}
+			else if (arg.starts_with("--")) {
+				return false;
+			}
+			else {
+				config.inputs.emplace_back(arg);
+			}
+		}
+
+		return !config.inputs.empty();
+	}
+}
+
+int main(int argc, char** argv) {
+
+	Convert_Config config;
+	if (!Parse_Arguments(argc, argv, config)) {
+		std::cerr << "Usage: " << argv[0] << " [--columns A,B,...] [--delimiter C] [--threads N] [--batch N] [--output DIR] FILE..." << std::endl;
+		return 1;
+	}
+
+	size_t threads = config.threads != 0 ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+
+	// the files are converted by separate workers, and each of them gets an equal share of the threads for its blocks
+	const size_t file_workers = std::min(threads, config.inputs.size());
+	const size_t block_threads = std::max<size_t>(threads / file_workers, 1);
+
+	std::atomic<size_t> next_input = 0;
+	std::atomic<size_t> failures = 0;
+	std::mutex log_mutex;
+
+	auto worker = [&]() {
+		for (size_t i = next_input++; i < config.inputs.size(); i = next_input++) {
+			std::string error;
+			try {
+				error = Convert_File(config, config.inputs[i], block_threads);
+			}
+			catch (const std::exception& ex) {
+				error = ex.what();
+			}
+
+			if (!error.empty()) {
+				failures++;
+				std::lock_guard lock(log_mutex);
+				std::cerr << config.inputs[i].string() << ": " << error << std::endl;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < file_workers; i++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (auto& thr : workers) {
+		thr.join();
+	}
+
+	return failures == 0 ? 0 : 2;
+}
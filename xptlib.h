@@ -29,15 +29,139 @@
 #include <bit>
 #include <concepts>
 #include <variant>
+#include <string>
 #include <string_view>
-#include <unordered_map>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <limits>
+#include <cmath>
+#include <tuple>
+#include <utility>
+#include <chrono>
 #include <iostream>
 
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define XPTLIB_HAS_MMAP 1
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define XPTLIB_HAS_MMAP 1
+#endif
+
+// support of compressed files is enabled by defining XPTLIB_WITH_ZLIB (gzip) and/or XPTLIB_WITH_ZSTD (zstd) prior to including this header;
+// the program must then be linked with the respective library (-lz, -lzstd)
+#if defined(XPTLIB_WITH_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(XPTLIB_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+// collection of the statistics of xpt::File reads (see File::Get_Stats) is enabled by defining XPTLIB_ENABLE_STATS prior to including this header;
+// otherwise, all the instrumentation is compiled out
+#if defined(XPTLIB_ENABLE_STATS)
+#define XPTLIB_STATS(...) __VA_ARGS__
+#else
+#define XPTLIB_STATS(...)
+#endif
+
+// SIMD kernels may be disabled by defining XPTLIB_NO_SIMD prior to including this header
+#if !defined(XPTLIB_NO_SIMD)
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define XPTLIB_TARGET_AVX2
+#define XPTLIB_TARGET_AVX512
+#else
+#define XPTLIB_TARGET_AVX2 __attribute__((target("avx2")))
+#define XPTLIB_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512cd")))
+#endif
+#define XPTLIB_SIMD_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define XPTLIB_SIMD_NEON 1
+#endif
+#endif
+
+// Apache Arrow C data interface (see https://arrow.apache.org/docs/format/CDataInterface.html); the structures are defined here
+// unless they were already defined by other headers (e.g., arrow/c/abi.h), so there is no dependency on the Arrow library
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)(struct ArrowSchema*);
+	void* private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)(struct ArrowArray*);
+	void* private_data;
+};
+
+#endif
+
 namespace xpt {
 
+	// variable type, matches the actual values of Namestr_Record_1::ntype
+	enum class NVar_Type {
+		Numeric = 1,	// is a double precision floating-point value encoded in IBM encoding
+		String  = 2,	// is an array of ASCII characters
+	};
+
+	// version of the transport format
+	enum class NFormat_Version {
+		V5 = 5,
+		V8 = 8,
+	};
+
 	// internal namespace - contents are not exposed to the user code
 	namespace internal {
 
+		// the enumerations were defined here originally; the aliases keep the code written against them working
+		using NVar_Type = xpt::NVar_Type;
+		using NFormat_Version = xpt::NFormat_Version;
+
 #pragma pack(push, 1)
 
 		// header record signatures
@@ -48,6 +172,15 @@ namespace xpt {
 		constexpr const char* Header_Signature_Namestr     = "NAMESTR HEADER RECORD";
 		constexpr const char* Header_Signature_Observation = "OBS     HEADER RECORD";
 
+		// header record signatures of the V8 format (long names and labels); label records are present only if needed
+		constexpr const char* Header_Signature_Library_V8     = "LIBV8   HEADER RECORD";
+		constexpr const char* Header_Signature_Member_V8      = "MEMBV8  HEADER RECORD";
+		constexpr const char* Header_Signature_Descriptor_V8  = "DSCPTV8 HEADER RECORD";
+		constexpr const char* Header_Signature_Namestr_V8     = "NAMSTV8 HEADER RECORD";
+		constexpr const char* Header_Signature_Observation_V8 = "OBSV8   HEADER RECORD";
+		constexpr const char* Header_Signature_Label_V8       = "LABELV8 HEADER RECORD";
+		constexpr const char* Header_Signature_Label_V9       = "LABELV9 HEADER RECORD";
+
 		// internal representation of header signature
 		enum class Header_Signature {
 			None = 0,
@@ -56,21 +189,65 @@ namespace xpt {
 			Member,
 			Descriptor,
 			Namestr,
-			Observation
+			Observation,
+			Label,			// long labels (V8 format)
+			Label_V9		// long labels and format names (V8 format written by SAS 9)
 		};
 
-		static const std::unordered_map<std::string_view, Header_Signature> Signature_Map{
-			{ Header_Signature_Library, Header_Signature::Library },
-			{ Header_Signature_Member, Header_Signature::Member },
-			{ Header_Signature_Descriptor, Header_Signature::Descriptor },
-			{ Header_Signature_Namestr, Header_Signature::Namestr },
-			{ Header_Signature_Observation, Header_Signature::Observation },
+		// there is just a handful of signatures, so a linear search over this table beats any hashing
+		inline constexpr std::tuple<std::string_view, Header_Signature, NFormat_Version> Signature_Table[] = {
+			{ Header_Signature_Library, Header_Signature::Library, NFormat_Version::V5 },
+			{ Header_Signature_Member, Header_Signature::Member, NFormat_Version::V5 },
+			{ Header_Signature_Descriptor, Header_Signature::Descriptor, NFormat_Version::V5 },
+			{ Header_Signature_Namestr, Header_Signature::Namestr, NFormat_Version::V5 },
+			{ Header_Signature_Observation, Header_Signature::Observation, NFormat_Version::V5 },
+			{ Header_Signature_Library_V8, Header_Signature::Library, NFormat_Version::V8 },
+			{ Header_Signature_Member_V8, Header_Signature::Member, NFormat_Version::V8 },
+			{ Header_Signature_Descriptor_V8, Header_Signature::Descriptor, NFormat_Version::V8 },
+			{ Header_Signature_Namestr_V8, Header_Signature::Namestr, NFormat_Version::V8 },
+			{ Header_Signature_Observation_V8, Header_Signature::Observation, NFormat_Version::V8 },
+			{ Header_Signature_Label_V8, Header_Signature::Label, NFormat_Version::V8 },
+			{ Header_Signature_Label_V9, Header_Signature::Label_V9, NFormat_Version::V8 },
 		};
 
-		// variable type, matches the actual values of Namestr_Record_1::ntype
-		enum class NVar_Type {
-			Numeric = 1,	// is a double precision floating-point value encoded in IBM encoding
-			String  = 2,	// is an array of ASCII characters
+		// recognizes the header type (and the version of the format, if requested) by the name field of the header record
+		inline Header_Signature Recognize_Signature(std::string_view namedesc, NFormat_Version* version = nullptr) {
+			for (const auto& [signature, type, format] : Signature_Table) {
+				if (signature == namedesc) {
+					if (version) {
+						*version = format;
+					}
+					return type;
+				}
+			}
+			return Header_Signature::None;
+		}
+
+		// recognizes the header type, and checks it is of a given version of the format
+		inline Header_Signature Recognize_Signature(std::string_view namedesc, NFormat_Version expected) {
+			NFormat_Version version = NFormat_Version::V5;
+			const auto type = Recognize_Signature(namedesc, &version);
+			return version == expected ? type : Header_Signature::None;
+		}
+
+		// parses a fixed-width decimal number field (e.g., a count in the header record); leading blanks are skipped,
+		// and parsing stops at the first non-digit character
+		inline size_t Parse_Digits(const char* str, size_t len) {
+			size_t i = 0;
+			for (; i < len && str[i] == ' '; i++);
+
+			size_t result = 0;
+			for (; i < len && str[i] >= '0' && str[i] <= '9'; i++) {
+				result = result * 10 + static_cast<size_t>(str[i] - '0');
+			}
+			return result;
+		}
+
+		// way of decoding a variable value from the observation row, determined once when reading the headers
+		enum class NDecode_Kind {
+			Number,			// full-length (8 bytes) IBM double
+			Short_Number,	// truncated IBM double (2 to 7 bytes), zero-extended to 8 bytes before conversion
+			String,			// array of characters
 		};
 
 		//ddMMMyy:hh:mm:ss - date and time modified
@@ -110,6 +287,16 @@ namespace xpt {
 			char num6[5];			// MEMBER - size of variable record (140 on classical HW, 136 on VAX/VMS)
 		};
 
+		// header of member section (V8 format - long dataset name)
+		struct Member_Header_Record_V8 {
+			char sas_symbol[8];			// always contains "SAS" padded with spaces
+			char sas_dsname[32];		// dataset name
+			char sasdata[8];			// always contains "SASDATA"
+			char sasver[8];				// version of SAS which was used to create this file
+			char sas_osname[8];			// operating system the SAS was running on when creating this file
+			Date_Time_Record created;	// date and time of creation
+		};
+
 		// header of member section
 		struct Member_Header_Record {
 			char sas_symbol[8];			// always contains "SAS" padded with spaces
@@ -150,7 +337,9 @@ namespace xpt {
 			uint16_t nifl;		// informat length attribute
 			uint16_t nifd;		// informat number of decimals
 			int32_t npos;		// offset of the variable in observation data
-			char rest[52];		// padding
+			char longname[32];	// V8 format - full variable name (padding in V5)
+			uint16_t lablen;	// V8 format - length of the label, labels longer than 40 characters are stored in the label records
+			char rest[18];		// padding
 		};
 
 #pragma pack(pop)
@@ -199,28 +388,44 @@ namespace xpt {
 		 * Retrieves a numeric value from buffer
 		 */
 		template<std::integral T>
-		inline T Get_From_Buffer(const std::vector<std::byte>& buf, const size_t offset) {
+		inline T Get_From_Buffer(std::span<const std::byte> buf, const size_t offset) {
 			T dst = static_cast<T>(0);
 			std::copy(buf.begin() + offset, buf.begin() + offset + sizeof(T), reinterpret_cast<std::byte*>(&dst));
 			return dst;
 		}
 
 		/**
-		 * Retrieves a string from buffer
+		 * Retrieves a record (packed structure) from buffer
 		 */
-		inline std::string Get_From_Buffer(const std::vector<std::byte>& buf, const size_t offset, const size_t len) {
-			std::string dst(len, '\0');
-			std::copy(buf.begin() + offset, buf.begin() + offset + len, reinterpret_cast<std::byte*>(dst.data()));
-			dst.erase(std::find_if(dst.rbegin(), dst.rend(), [](unsigned char ch) {
-				return !std::isspace(ch) && ch != '\0';
-			}).base(), dst.end());
-			dst.erase(dst.begin(), std::find_if(dst.begin(), dst.end(), [](unsigned char ch) {
-				return !std::isspace(ch);
-			}));
+		template<typename T> requires (std::is_trivially_copyable_v<T> && !std::integral<T>)
+		inline T Get_From_Buffer(std::span<const std::byte> buf, const size_t offset) {
+			T dst;
+			std::memcpy(&dst, buf.data() + offset, sizeof(T));
+			return dst;
+		}
 
+		/**
+		 * Retrieves a raw IBM number truncated to a given length (up to 8 bytes) from buffer; the missing low-order bytes are zero
+		 */
+		inline uint64_t Get_Number_From_Buffer(std::span<const std::byte> buf, const size_t offset, const size_t len) {
+			uint64_t dst = 0;
+			std::copy_n(buf.begin() + offset, len, reinterpret_cast<std::byte*>(&dst));
 			return dst;
 		}
 
+		// is the character a whitespace? (the same set as std::isspace in the "C" locale, without the locale lookup)
+		constexpr bool Is_Blank(char ch) {
+			return ch == ' ' || (ch >= '\t' && ch <= '\r');
+		}
+
+		// quiet NaN representing SAS missing values in IEEE 754; the missing value code is stored in the low byte of the payload
+		constexpr uint64_t Ieee_Missing_Value = 0x7ff8000000000000ULL;
+
+		// is the character a valid SAS missing value code ('.', '_' or 'A' to 'Z')?
+		constexpr bool Is_Missing_Code(uint64_t code) {
+			return code == '.' || code == '_' || (code >= 'A' && code <= 'Z');
+		}
+
 		/**
 		 * Converts the IBM double precision floating-point format to standard IEEE 754
 		 *
@@ -230,9 +435,12 @@ namespace xpt {
 		 * https://en.wikipedia.org/wiki/IBM_hexadecimal_floating-point
 		 * http://www.bitsavers.org/pdf/ibm/360/princOps/A22-6821-6_360PrincOpsJan67.pdf
 		 * 
+		 * Values with zero mantissa are either zeros (zero exponent), or SAS missing values, where the first byte holds the missing value
+		 * code ('.', '_' or 'A' to 'Z'); missing values are converted to a quiet NaN carrying the code (see Ieee_Missing_Value)
+		 *
 		 * input in uint64_t is a raw big-endian representation, read directly from the data
 		 */
-		double IbmToIEEE(uint64_t raw) {
+		inline double IbmToIEEE(uint64_t raw) {
 
 			const uint64_t in = To_Machine_Endian_Raw(raw);
 
@@ -258,301 +466,5898 @@ namespace xpt {
 			exponent = exponent + shift + 1023ULL;
 			auto ieee = sign | (exponent << 52ULL) | mantissa;
 
+			// zero and missing values (compiled to conditional moves)
+			const auto code = (in >> 56ULL) & 0x7fULL;
+			const auto special = (code == 0) ? sign : (Ieee_Missing_Value | code);
+			ieee = ((in & 0x00ffffffffffffffULL) == 0) ? special : ieee;
+
 			return std::bit_cast<double>(ieee);
 		}
-	}
 
-	enum class NStatus {
-		Ok,
-		No_Library_Header,
-		No_Member_Header,
-		No_Descriptor_Header,
-		No_Namestr_Header,
-		No_Observation_Header,
-	};
+		/**
+		 * Bulk IBM to IEEE 754 conversion kernels; all of them produce results bit-identical to the scalar IbmToIEEE
+		 *
+		 * The normalization shift (count of leading zero bits of the first hexadecimal digit of mantissa, subtracted from 3) is computed
+		 * without branching - either by comparing the mantissa against the 2^55, 2^54 and 2^53 thresholds, or using the leading zero count
+		 * instruction, where available
+		 */
+		inline void IbmToIEEE_Scalar(const uint64_t* in, double* out, size_t n) {
+			for (size_t i = 0; i < n; i++) {
+				out[i] = IbmToIEEE(in[i]);
+			}
+		}
 
-	// universal transport variant used to export value from internal representation
-	using TValue = std::variant<std::string, double>;
+#if defined(XPTLIB_SIMD_X86)
 
-	/**
-	 * A class representing XPT file loader
-	 */
-	class File {
+		XPTLIB_TARGET_AVX2 inline void IbmToIEEE_AVX2(const uint64_t* in, double* out, size_t n) {
 
-		private:
-			// input file stream of XPT file
-			std::ifstream mFile;
-
-			// record of a variable
-			struct Variable_Record {
-				std::string name;
-				std::string label;
-				internal::NVar_Type type;
-				size_t length;
-				size_t varNum;
-				size_t position; // offset in data
-			};
+			const __m256i byte_swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+			const __m256i sign_mask = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+			const __m256i exponent_mask = _mm256_set1_epi64x(0x7f);
+			const __m256i mantissa_mask = _mm256_set1_epi64x(0x00ffffffffffffffLL);
+			const __m256i implicit_mask = _mm256_set1_epi64x(static_cast<long long>(0xffefffffffffffffULL));
+			const __m256i threshold_3 = _mm256_set1_epi64x(0x007fffffffffffffLL);
+			const __m256i threshold_2 = _mm256_set1_epi64x(0x003fffffffffffffLL);
+			const __m256i threshold_1 = _mm256_set1_epi64x(0x001fffffffffffffLL);
+			const __m256i bias = _mm256_set1_epi64x(1023 - (65 << 2));
+			const __m256i missing = _mm256_set1_epi64x(static_cast<long long>(Ieee_Missing_Value));
+			const __m256i zero = _mm256_setzero_si256();
 
-			// internal exception for EOF signalization
-			class CEOF_Exception : public std::runtime_error {
-				public:
-					using std::runtime_error::runtime_error;
-			};
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				const __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), byte_swap);
 
-			// stored variables
-			std::vector<Variable_Record> mVariables;
+				const __m256i sign = _mm256_and_si256(v, sign_mask);
+				const __m256i exponent = _mm256_and_si256(_mm256_srli_epi64(v, 56), exponent_mask);
+				__m256i mantissa = _mm256_and_si256(v, mantissa_mask);
 
-			// actual record ("row") length (so we can properly read the records) - this is a sum of all variable lengths
-			size_t mRecord_Len = 0;
+				// each comparison yields -1 when the mantissa reaches the threshold; the mantissa is never negative here
+				const __m256i shift = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_add_epi64(_mm256_add_epi64(
+					_mm256_cmpgt_epi64(mantissa, threshold_3),
+					_mm256_cmpgt_epi64(mantissa, threshold_2)),
+					_mm256_cmpgt_epi64(mantissa, threshold_1)));
 
-		private:
-			// read a given structure from file; if padding is enabled, the read is extended to 80 bytes, but only a lower part corresponding to given type is returned
-			template<typename T, bool padded = true>
-			T Read() {
-				const size_t bytes_to_read = (padded ? 80 : sizeof(T));
+				const __m256i zero_mantissa = _mm256_cmpeq_epi64(mantissa, zero);
+				mantissa = _mm256_and_si256(_mm256_srlv_epi64(mantissa, shift), implicit_mask);
+				const __m256i ieee_exponent = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(exponent, 2), shift), bias);
 
-				// always add padding, even if no padding is requested to simplify things
-				struct {
-					union {
-						T data;
-						char padded[80];
-					};
-				} data_padded;
+				__m256i ieee = _mm256_or_si256(_mm256_or_si256(sign, _mm256_slli_epi64(ieee_exponent, 52)), mantissa);
 
-				// read and check size read
-				mFile.read(reinterpret_cast<char*>(&data_padded.data), bytes_to_read);
-				if (mFile.gcount() != bytes_to_read)
-					throw CEOF_Exception{ "Cannot read requested data" };
+				// zero mantissa - zero (zero exponent), or missing value (the exponent holds the missing value code)
+				const __m256i special = _mm256_blendv_epi8(_mm256_or_si256(missing, exponent), sign, _mm256_cmpeq_epi64(exponent, zero));
+				ieee = _mm256_blendv_epi8(ieee, special, zero_mantissa);
 
-				return data_padded.data;
+				_mm256_storeu_pd(out + i, _mm256_castsi256_pd(ieee));
 			}
 
-			// reads a given count of bytes into target vector
-			void Read(std::vector<std::byte>& target, size_t byte_count) {
-				target.resize(byte_count);
-				mFile.read(reinterpret_cast<char*>(target.data()), byte_count);
-				if (mFile.gcount() != byte_count)
-					throw CEOF_Exception{ "Cannot read requested data" };
-			}
+			IbmToIEEE_Scalar(in + i, out + i, n - i);
+		}
 
-			// discards a given count of bytes from input stream
-			void Read_Discard(size_t count) noexcept {
-				mFile.seekg(count, std::ios::cur);
-			}
+// some GCC versions report false uninitialized warnings from within the AVX-512 intrinsic headers
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 
-			// recognized data header based on its signature
-			static internal::Header_Signature Recognize_Data_Header(const internal::Data_Header_Generic& gen) {
-				auto itr = internal::Signature_Map.find(std::string_view{ gen.namedesc, sizeof(gen.namedesc) });
-				if (itr == internal::Signature_Map.end()) {
-					return internal::Header_Signature::None;
-				}
+		XPTLIB_TARGET_AVX512 inline void IbmToIEEE_AVX512(const uint64_t* in, double* out, size_t n) {
+
+			const __m512i byte_swap = _mm512_broadcast_i32x4(_mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+			const __m512i sign_mask = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+			const __m512i exponent_mask = _mm512_set1_epi64(0x7f);
+			const __m512i mantissa_mask = _mm512_set1_epi64(0x00ffffffffffffffLL);
+			const __m512i implicit_mask = _mm512_set1_epi64(static_cast<long long>(0xffefffffffffffffULL));
+			const __m512i max_shift = _mm512_set1_epi64(11);
+			const __m512i bias = _mm512_set1_epi64(1023 - (65 << 2));
+			const __m512i missing = _mm512_set1_epi64(static_cast<long long>(Ieee_Missing_Value));
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8) {
+				const __m512i v = _mm512_shuffle_epi8(_mm512_loadu_si512(in + i), byte_swap);
+
+				const __m512i sign = _mm512_and_si512(v, sign_mask);
+				const __m512i exponent = _mm512_and_si512(_mm512_srli_epi64(v, 56), exponent_mask);
+				__m512i mantissa = _mm512_and_si512(v, mantissa_mask);
+
+				// mantissa occupies the low 56 bits, so the leading zero count is 8 to 11 for normalized values
+				const __m512i shift = _mm512_max_epi64(_mm512_sub_epi64(max_shift, _mm512_lzcnt_epi64(mantissa)), _mm512_setzero_si512());
+
+				const __mmask8 zero_mantissa = _mm512_testn_epi64_mask(mantissa, mantissa);
+				mantissa = _mm512_and_si512(_mm512_srlv_epi64(mantissa, shift), implicit_mask);
+				const __m512i ieee_exponent = _mm512_add_epi64(_mm512_add_epi64(_mm512_slli_epi64(exponent, 2), shift), bias);
+
+				__m512i ieee = _mm512_or_si512(_mm512_or_si512(sign, _mm512_slli_epi64(ieee_exponent, 52)), mantissa);
 
-				return itr->second;
+				// zero mantissa - zero (zero exponent), or missing value (the exponent holds the missing value code)
+				const __m512i special = _mm512_mask_mov_epi64(_mm512_or_si512(missing, exponent), _mm512_testn_epi64_mask(exponent, exponent), sign);
+				ieee = _mm512_mask_mov_epi64(ieee, zero_mantissa, special);
+
+				_mm512_storeu_pd(out + i, _mm512_castsi512_pd(ieee));
 			}
 
-			// fetches the column by its ID. The parameter must match the column type, otherwise the column value is converted (an in case of invalid type, an exception may be raised according to standard library rules)
-			template<typename Arg0>
-			void Fetch_Column_Idx(const std::vector<std::byte>& data, size_t argIdx, Arg0& arg) {
+			IbmToIEEE_AVX2(in + i, out + i, n - i);
+		}
 
-				const auto& mvar = mVariables[argIdx];
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
-				// is the parameter a numeric type (double precision)? fetch number
-				if constexpr (std::is_same_v<std::decay_t<Arg0>, double>) {
-					if (mvar.type == internal::NVar_Type::Numeric) {
-						const auto num_raw = internal::Get_From_Buffer<uint64_t>(data, mvar.position);
-						arg = internal::IbmToIEEE(num_raw);
-					}
-					else {
-						arg = std::stod(internal::Get_From_Buffer(data, mvar.position, mvar.length));
-					}
-				}
-				// otherwise fetch a string
-				else {
-					if (mvar.type == internal::NVar_Type::String) {
-						arg = internal::Get_From_Buffer(data, mvar.position, mvar.length);
-					}
-					else {
-						const auto num_raw = internal::Get_From_Buffer<uint64_t>(data, mvar.position);
-						arg = std::to_string(internal::IbmToIEEE(num_raw));
-					}
-				}
+		// instruction set extensions usable by the kernels (supported by both CPU and OS)
+		struct Cpu_Features {
+			bool avx2 = false;
+			bool avx512 = false;	// F + BW + CD subsets
+		};
+
+		inline Cpu_Features Detect_Cpu_Features() {
+			Cpu_Features features;
+#if defined(_MSC_VER)
+			int regs[4];
+			__cpuid(regs, 0);
+			if (regs[0] < 7) {
+				return features;
 			}
 
-			// recursion stop method to fetch the last column
-			template<typename Arg0>
-			void Fetch_Column(const std::vector<std::byte>& data, const size_t origCnt, Arg0& arg) {
-				Fetch_Column_Idx(data, origCnt - 1, arg);
+			__cpuid(regs, 1);
+			const bool osxsave = (regs[2] & (1 << 27)) != 0;
+			if (!osxsave) {
+				return features;
 			}
 
-			// variadic method to retrieve columns to given parameters with known types
-			template<typename Arg0, typename... Args>
-			void Fetch_Column(const std::vector<std::byte>& data, const size_t origCnt, Arg0& arg, Args&... args) {
+			const unsigned long long xcr0 = _xgetbv(0);
+			__cpuidex(regs, 7, 0);
 
-				const size_t i = origCnt - (sizeof...(Args) + 1);
+			features.avx2 = (xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0;
+			features.avx512 = features.avx2 && (xcr0 & 0xe6) == 0xe6
+				&& (regs[1] & (1 << 16)) != 0 && (regs[1] & (1 << 28)) != 0 && (regs[1] & (1 << 30)) != 0;
+#else
+			__builtin_cpu_init();
+			features.avx2 = __builtin_cpu_supports("avx2");
+			features.avx512 = features.avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512cd");
+#endif
+			return features;
+		}
 
-				Fetch_Column_Idx(data, i, arg);
-				Fetch_Column(data, origCnt, args...);
+#elif defined(XPTLIB_SIMD_NEON)
+
+		inline void IbmToIEEE_NEON(const uint64_t* in, double* out, size_t n) {
+
+			const uint64x2_t sign_mask = vdupq_n_u64(0x8000000000000000ULL);
+			const uint64x2_t exponent_mask = vdupq_n_u64(0x7f);
+			const uint64x2_t mantissa_mask = vdupq_n_u64(0x00ffffffffffffffULL);
+			const uint64x2_t implicit_mask = vdupq_n_u64(0xffefffffffffffffULL);
+			const uint64x2_t threshold_3 = vdupq_n_u64(0x007fffffffffffffULL);
+			const uint64x2_t threshold_2 = vdupq_n_u64(0x003fffffffffffffULL);
+			const uint64x2_t threshold_1 = vdupq_n_u64(0x001fffffffffffffULL);
+			const uint64x2_t bias = vdupq_n_u64(1023 - (65 << 2));
+			const uint64x2_t missing = vdupq_n_u64(Ieee_Missing_Value);
+
+			size_t i = 0;
+			for (; i + 2 <= n; i += 2) {
+				const uint64x2_t v = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(in + i))));
+
+				const uint64x2_t sign = vandq_u64(v, sign_mask);
+				const uint64x2_t exponent = vandq_u64(vshrq_n_u64(v, 56), exponent_mask);
+				uint64x2_t mantissa = vandq_u64(v, mantissa_mask);
+
+				// each comparison yields all ones (-1) when the mantissa reaches the threshold
+				const uint64x2_t shift = vsubq_u64(vdupq_n_u64(0), vaddq_u64(vaddq_u64(
+					vcgtq_u64(mantissa, threshold_3),
+					vcgtq_u64(mantissa, threshold_2)),
+					vcgtq_u64(mantissa, threshold_1)));
+
+				const uint64x2_t zero_mantissa = vceqzq_u64(mantissa);
+
+				// shift right by a variable amount is a shift left by a negative amount
+				mantissa = vandq_u64(vshlq_u64(mantissa, vnegq_s64(vreinterpretq_s64_u64(shift))), implicit_mask);
+				const uint64x2_t ieee_exponent = vaddq_u64(vaddq_u64(vshlq_n_u64(exponent, 2), shift), bias);
+
+				uint64x2_t ieee = vorrq_u64(vorrq_u64(sign, vshlq_n_u64(ieee_exponent, 52)), mantissa);
+
+				// zero mantissa - zero (zero exponent), or missing value (the exponent holds the missing value code)
+				const uint64x2_t special = vbslq_u64(vceqzq_u64(exponent), sign, vorrq_u64(missing, exponent));
+				ieee = vbslq_u64(zero_mantissa, special, ieee);
+
+				vst1q_f64(out + i, vreinterpretq_f64_u64(ieee));
 			}
 
-		public:
-			File() = default;
-			virtual ~File() = default;
+			IbmToIEEE_Scalar(in + i, out + i, n - i);
+		}
 
-			/**
-			 * Opens the given file, checks for existence implicitly
-			 * Returns true on success, false on failure (file does not exist, insufficient rights, ...)
-			 */
-			bool Open(const std::filesystem::path& path) {
-				mFile.open(path, std::ios::in | std::ios::binary);
-				return mFile.is_open();
+#endif
+
+		using IbmToIEEE_Kernel = void(*)(const uint64_t*, double*, size_t);
+
+		// selects the fastest conversion kernel supported by the machine
+		inline IbmToIEEE_Kernel Select_IbmToIEEE_Kernel() {
+#if defined(XPTLIB_SIMD_X86)
+			const auto features = Detect_Cpu_Features();
+			if (features.avx512) {
+				return IbmToIEEE_AVX512;
+			}
+			if (features.avx2) {
+				return IbmToIEEE_AVX2;
 			}
+#elif defined(XPTLIB_SIMD_NEON)
+			return IbmToIEEE_NEON;
+#endif
+			return IbmToIEEE_Scalar;
+		}
 
-			/**
-			 * Reads the file headers, variables and other meta-information; this must be done prior to Read_Next call
-			 * Returns NStatus::Ok on success, or other codes if an error has occurred
-			 */
-			NStatus Read_Headers() {
+		/**
+		 * Converts n IBM double precision values (raw big-endian representation, as read from the data) to IEEE 754
+		 * The implementation is chosen at runtime according to the instruction sets supported by the CPU; in and out may be the same array
+		 */
+		inline void IbmToIEEE(const uint64_t* in, double* out, size_t n) {
+			static const IbmToIEEE_Kernel kernel = Select_IbmToIEEE_Kernel();
+			kernel(in, out, n);
+		}
 
-				internal::Data_Header_Generic hdr;
+		/**
+		 * Extracts the SAS missing value codes of n IBM values (raw big-endian representation) - the code of each missing value,
+		 * or zero for non-missing values, and the validity bitmap (bit i % 8 of byte i / 8 is set for non-missing values)
+		 * The bitmap is written starting from its first byte, so the values should be processed in chunks of a multiple of 8
+		 * Returns the count of missing values
+		 */
+		inline size_t Extract_Missing(const uint64_t* in, char* codes, uint8_t* validity, size_t n) {
 
-				hdr = Read<internal::Data_Header_Generic>();
-				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Library) {
-					return NStatus::No_Library_Header;
+			// fast path for chunks without missing values; the masks are applied to the raw (big-endian) values
+			const uint64_t mantissa_mask = To_Machine_Endian_Raw(0x00ffffffffffffffULL);
+			const uint64_t code_mask = To_Machine_Endian_Raw(0x7f00000000000000ULL);
+			bool any_missing = false;
+			for (size_t i = 0; i < n; i++) {
+				any_missing |= ((in[i] & mantissa_mask) == 0) & ((in[i] & code_mask) != 0);
+			}
+			if (!any_missing) {
+				std::fill_n(codes, n, '\0');
+				std::fill_n(validity, n / 8, uint8_t{ 0xff });
+				if (n % 8 != 0) {
+					validity[n / 8] = static_cast<uint8_t>((1 << (n % 8)) - 1);
 				}
+				return 0;
+			}
 
-				// We don't really use any of the information provided in these headers for now
-				/*auto file_header = */ Read<internal::File_Header_Record>();
-				/*auto created_at =  */ Read<internal::Date_Time_Record>();
+			size_t missing = 0;
+			for (size_t i = 0; i < n; i += 8) {
+				const size_t cnt = std::min<size_t>(8, n - i);
+				uint8_t bits = 0;
+				for (size_t j = 0; j < cnt; j++) {
+					const uint64_t v = To_Machine_Endian_Raw(in[i + j]);
+					const uint64_t code = (v >> 56ULL) & 0x7fULL;
+					const bool is_missing = (v & 0x00ffffffffffffffULL) == 0 && code != 0;
 
-				hdr = Read<internal::Data_Header_Generic>();
-				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Member) {
-					return NStatus::No_Member_Header;
+					codes[i + j] = is_missing ? (Is_Missing_Code(code) ? static_cast<char>(code) : '.') : '\0';
+					bits |= static_cast<uint8_t>(is_missing ? 0 : 1) << j;
+					missing += is_missing ? 1 : 0;
 				}
+				validity[i / 8] = bits;
+			}
+			return missing;
+		}
 
-				// TODO: parse variable record length from "next" (last 5 bytes - next.num6)
+		// SAS missing numeric value (".")
+		constexpr uint64_t Ibm_Missing_Value = 0x2e00000000000000ULL;
 
-				hdr = Read<internal::Data_Header_Generic>();
-				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Descriptor) {
-					return NStatus::No_Descriptor_Header;
-				}
+		// largest magnitude representable in IBM double precision (without sign)
+		constexpr uint64_t Ibm_Max_Magnitude = 0x7fffffffffffffffULL;
 
-				// We don't really use any of the information provided in these headers for now
-				/*auto member_header_1 = */ Read<internal::Member_Header_Record>();
-				/*auto member_header_2 = */ Read<internal::Member_Header_Record_2>();
+		/**
+		 * Converts the IEEE 754 double precision value to IBM double precision floating-point format; inverse of IbmToIEEE
+		 *
+		 * The IEEE binary exponent is split into the hexadecimal exponent and a left shift of mantissa (0-3 bits), so the 53-bit IEEE
+		 * mantissa fits the 56-bit IBM mantissa without any loss of precision. Values too small to be represented are stored as zero,
+		 * values too large are clamped to the largest IBM value, and NaNs and infinities are stored as SAS missing values; NaNs carrying
+		 * a missing value code (see Ieee_Missing_Value) keep their code, all the others are stored as the "." missing value
+		 *
+		 * output in uint64_t is a raw big-endian representation, to be written directly to the data
+		 */
+		inline uint64_t IEEEToIbm(double value) {
 
-				hdr = Read<internal::Data_Header_Generic>();
+			const auto in = std::bit_cast<uint64_t>(value);
 
-				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Namestr) {
-					return NStatus::No_Namestr_Header;
-				}
+			const auto sign = in & 0x8000000000000000ULL;
+			const auto exponent = (in >> 52ULL) & 0x7ffULL;
+			const auto mantissa = (in & 0x000fffffffffffffULL) | 0x0010000000000000ULL;
 
-				size_t readCnt = 0;
-				mRecord_Len = 0;
-				const size_t cnt = std::stoull(std::string{ hdr.num2, 5 });
+			// hexadecimal exponent (biased by 192 against IBM exponent); the remainder determines the mantissa shift
+			const auto hex_exponent = (exponent + 5ULL) >> 2ULL;
+			const auto shift = (exponent + 5ULL) & 3ULL;
 
-				// read all variable descriptors ("namestrs") and store them in minimal, internal representation
-				for (size_t i = 0; i < cnt; i++) {
+			uint64_t ibm;
+			if (exponent == 0x7ffULL) {
+				const auto code = in & 0xffULL;
+				ibm = Is_Missing_Code(code) ? (code << 56ULL) : Ibm_Missing_Value;
+			}
+			else if (hex_exponent < 192ULL) {
+				ibm = 0;
+			}
+			else if (hex_exponent > 319ULL) {
+				ibm = sign | Ibm_Max_Magnitude;
+			}
+			else {
+				ibm = sign | ((hex_exponent - 192ULL) << 56ULL) | (mantissa << shift);
+			}
 
-					const auto namestr1 = Read<internal::Namestr_Record_1, false>();
-					const auto namestr2 = Read<internal::Namestr_Record_2, false>();
+			return To_Machine_Endian_Raw(ibm);
+		}
 
-					readCnt += sizeof(internal::Namestr_Record_1) + sizeof(internal::Namestr_Record_2);
+		/**
+		 * Bulk IEEE 754 to IBM conversion kernels; all of them produce results bit-identical to the scalar IEEEToIbm
+		 */
+		inline void IEEEToIbm_Scalar(const double* in, uint64_t* out, size_t n) {
+			for (size_t i = 0; i < n; i++) {
+				out[i] = IEEEToIbm(in[i]);
+			}
+		}
 
-					auto varLength = static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr1.nlng));
+#if defined(XPTLIB_SIMD_X86)
 
-					mVariables.emplace_back(
-						internal::Char_To_String(namestr1.nname),
-						internal::Char_To_String(namestr1.nlabel),
-						static_cast<internal::NVar_Type>(internal::To_Machine_Endian_Raw(namestr1.ntype)),
-						varLength,
-						static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr1.nvar0)),
-						static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr2.npos))
-					);
+		XPTLIB_TARGET_AVX2 inline void IEEEToIbm_AVX2(const double* in, uint64_t* out, size_t n) {
 
-					// increase row length
-					mRecord_Len += varLength;
-				}
+			const __m256i byte_swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+			const __m256i sign_mask = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+			const __m256i exponent_mask = _mm256_set1_epi64x(0x7ff);
+			const __m256i fraction_mask = _mm256_set1_epi64x(0x000fffffffffffffLL);
+			const __m256i implicit_bit = _mm256_set1_epi64x(0x0010000000000000LL);
+			const __m256i five = _mm256_set1_epi64x(5);
+			const __m256i three = _mm256_set1_epi64x(3);
+			const __m256i hex_bias = _mm256_set1_epi64x(192);
+			const __m256i hex_max = _mm256_set1_epi64x(319);
+			const __m256i max_magnitude = _mm256_set1_epi64x(static_cast<long long>(Ibm_Max_Magnitude));
+			const __m256i missing = _mm256_set1_epi64x(static_cast<long long>(Ibm_Missing_Value));
+			const __m256i code_mask = _mm256_set1_epi64x(0xff);
+			const __m256i code_letter = _mm256_set1_epi64x('A');
+			const __m256i code_letters = _mm256_set1_epi64x('Z' - 'A');
+			const __m256i code_underscore = _mm256_set1_epi64x('_');
+			const __m256i minus_one = _mm256_set1_epi64x(-1);
 
-				// padding - discard empty spaces
-				const size_t rest = readCnt % 80;
-				if (rest != 0) {
-					Read_Discard(80 - rest);
-				}
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				const __m256i v = _mm256_castpd_si256(_mm256_loadu_pd(in + i));
 
-				// expect the observation header as last header
-				hdr = Read<internal::Data_Header_Generic>();
-				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Observation) {
-					return NStatus::No_Observation_Header;
-				}
+				const __m256i sign = _mm256_and_si256(v, sign_mask);
+				const __m256i exponent = _mm256_and_si256(_mm256_srli_epi64(v, 52), exponent_mask);
+				const __m256i mantissa = _mm256_or_si256(_mm256_and_si256(v, fraction_mask), implicit_bit);
 
-				return NStatus::Ok;
+				const __m256i biased = _mm256_add_epi64(exponent, five);
+				const __m256i hex_exponent = _mm256_srli_epi64(biased, 2);
+				const __m256i shift = _mm256_and_si256(biased, three);
+
+				__m256i ibm = _mm256_or_si256(_mm256_or_si256(sign, _mm256_slli_epi64(_mm256_sub_epi64(hex_exponent, hex_bias), 56)), _mm256_sllv_epi64(mantissa, shift));
+
+				// all the values compared are small positive numbers, so the signed comparison is sufficient
+				ibm = _mm256_andnot_si256(_mm256_cmpgt_epi64(hex_bias, hex_exponent), ibm);
+				ibm = _mm256_blendv_epi8(ibm, _mm256_or_si256(sign, max_magnitude), _mm256_cmpgt_epi64(hex_exponent, hex_max));
+				// missing value code from the NaN payload - "_" or a letter (otherwise ".")
+				const __m256i code = _mm256_and_si256(v, code_mask);
+				const __m256i letter = _mm256_sub_epi64(code, code_letter);
+				const __m256i valid_code = _mm256_or_si256(_mm256_cmpeq_epi64(code, code_underscore),
+					_mm256_andnot_si256(_mm256_cmpgt_epi64(letter, code_letters), _mm256_cmpgt_epi64(letter, minus_one)));
+				const __m256i missing_code = _mm256_blendv_epi8(missing, _mm256_slli_epi64(code, 56), valid_code);
+				ibm = _mm256_blendv_epi8(ibm, missing_code, _mm256_cmpeq_epi64(exponent, exponent_mask));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(ibm, byte_swap));
 			}
 
-			/**
-			 * Reads next row and pushes the result to target vector
-			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
-			 */
-			bool Read_Next(std::vector<TValue>& target) {
+			IEEEToIbm_Scalar(in + i, out + i, n - i);
+		}
 
-				target.resize(mVariables.size());
+#elif defined(XPTLIB_SIMD_NEON)
 
-				std::vector<std::byte> data(mRecord_Len);
-				try {
-					Read(data, mRecord_Len);
-				}
-				catch (CEOF_Exception&) {
-					return false;
-				}
+		inline void IEEEToIbm_NEON(const double* in, uint64_t* out, size_t n) {
 
-				// read the whole row into a vector
-				for (size_t i = 0; i < mVariables.size(); i++) {
+			const uint64x2_t sign_mask = vdupq_n_u64(0x8000000000000000ULL);
+			const uint64x2_t exponent_mask = vdupq_n_u64(0x7ff);
+			const uint64x2_t fraction_mask = vdupq_n_u64(0x000fffffffffffffULL);
+			const uint64x2_t implicit_bit = vdupq_n_u64(0x0010000000000000ULL);
+			const uint64x2_t five = vdupq_n_u64(5);
+			const uint64x2_t three = vdupq_n_u64(3);
+			const uint64x2_t hex_bias = vdupq_n_u64(192);
+			const uint64x2_t hex_max = vdupq_n_u64(319);
+			const uint64x2_t max_magnitude = vdupq_n_u64(Ibm_Max_Magnitude);
+			const uint64x2_t missing = vdupq_n_u64(Ibm_Missing_Value);
+			const uint64x2_t code_mask = vdupq_n_u64(0xff);
+			const uint64x2_t code_letter = vdupq_n_u64('A');
+			const uint64x2_t code_letters = vdupq_n_u64('Z' - 'A');
+			const uint64x2_t code_underscore = vdupq_n_u64('_');
 
-					const auto& mvar = mVariables[i];
+			size_t i = 0;
+			for (; i + 2 <= n; i += 2) {
+				const uint64x2_t v = vreinterpretq_u64_f64(vld1q_f64(in + i));
 
-					if (mvar.type == internal::NVar_Type::Numeric) {
-						const auto num_raw = internal::Get_From_Buffer<uint64_t>(data, mvar.position);
-						target[i] = internal::IbmToIEEE(num_raw);
-					}
-					else if (mvar.type == internal::NVar_Type::String) {
-						target[i] = internal::Get_From_Buffer(data, mvar.position, mvar.length);
-					}
-				}
+				const uint64x2_t sign = vandq_u64(v, sign_mask);
+				const uint64x2_t exponent = vandq_u64(vshrq_n_u64(v, 52), exponent_mask);
+				const uint64x2_t mantissa = vorrq_u64(vandq_u64(v, fraction_mask), implicit_bit);
 
-				return true;
+				const uint64x2_t biased = vaddq_u64(exponent, five);
+				const uint64x2_t hex_exponent = vshrq_n_u64(biased, 2);
+				const uint64x2_t shift = vandq_u64(biased, three);
+
+				uint64x2_t ibm = vorrq_u64(vorrq_u64(sign, vshlq_n_u64(vsubq_u64(hex_exponent, hex_bias), 56)), vshlq_u64(mantissa, vreinterpretq_s64_u64(shift)));
+
+				ibm = vbicq_u64(ibm, vcltq_u64(hex_exponent, hex_bias));
+				ibm = vbslq_u64(vcgtq_u64(hex_exponent, hex_max), vorrq_u64(sign, max_magnitude), ibm);
+				// missing value code from the NaN payload - "_" or a letter (otherwise ".")
+				const uint64x2_t code = vandq_u64(v, code_mask);
+				const uint64x2_t valid_code = vorrq_u64(vceqq_u64(code, code_underscore), vcleq_u64(vsubq_u64(code, code_letter), code_letters));
+				const uint64x2_t missing_code = vbslq_u64(valid_code, vshlq_n_u64(code, 56), missing);
+				ibm = vbslq_u64(vceqq_u64(exponent, exponent_mask), missing_code, ibm);
+
+				vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vrev64q_u8(vreinterpretq_u8_u64(ibm)));
 			}
 
-			/**
-			 * Reads next row and stores the result to target parameters of known type
-			 * Please note, that if the parameter type does not match the column type, the value is converted by the
-			 * internal rule set (standard library std::stod or std::to_string).
-			 * Parameters are passed from 0 to N-1, so e.g., if the user specifies only 3 parameters out of 5 columns in total, the last 2 columns are discarded
-			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
-			 */
-			template<typename... Args>
-			bool Read_Next(Args&... args) {
+			IEEEToIbm_Scalar(in + i, out + i, n - i);
+		}
 
-				// store the original argument count, to properly assign values from left to right during recursion
-				const size_t originalArgCount = sizeof...(Args);
+#endif
 
-				std::vector<std::byte> data(mRecord_Len);
-				try {
-					Read(data, mRecord_Len);
-				}
-				catch (CEOF_Exception&) {
-					return false;
-				}
+		using IEEEToIbm_Kernel = void(*)(const double*, uint64_t*, size_t);
 
-				Fetch_Column(data, originalArgCount, args...);
+		// selects the fastest conversion kernel supported by the machine
+		inline IEEEToIbm_Kernel Select_IEEEToIbm_Kernel() {
+#if defined(XPTLIB_SIMD_X86)
+			if (Detect_Cpu_Features().avx2) {
+				return IEEEToIbm_AVX2;
+			}
+#elif defined(XPTLIB_SIMD_NEON)
+			return IEEEToIbm_NEON;
+#endif
+			return IEEEToIbm_Scalar;
+		}
 
-				return true;
+		/**
+		 * Converts n IEEE 754 values to IBM double precision (raw big-endian representation, to be written directly to the data)
+		 * The implementation is chosen at runtime according to the instruction sets supported by the CPU
+		 */
+		inline void IEEEToIbm(const double* in, uint64_t* out, size_t n) {
+			static const IEEEToIbm_Kernel kernel = Select_IEEEToIbm_Kernel();
+			kernel(in, out, n);
+		}
+
+		// is the character trimmed from the end of string values? (a whitespace or NUL)
+		constexpr bool Is_Trailing_Blank(char ch) {
+			return Is_Blank(ch) || ch == '\0';
+		}
+
+		/**
+		 * Determines the length of the string after trimming trailing blanks and NULs (i.e., the position after the last non-blank byte)
+		 */
+		inline size_t Trimmed_Length_Scalar(const char* str, size_t len) {
+			while (len != 0 && Is_Trailing_Blank(str[len - 1])) {
+				len--;
 			}
+			return len;
+		}
 
-			/**
-			 * Retrieves a vector of variables
-			 */
+#if defined(XPTLIB_SIMD_X86)
+
+		// scans the string backwards by 32 bytes, looking for the last non-blank byte
+		XPTLIB_TARGET_AVX2
+		inline size_t Trimmed_Length_AVX2(const char* str, size_t len) {
+
+			const __m256i space = _mm256_set1_epi8(' ');
+			const __m256i tab = _mm256_set1_epi8('\t');
+			const __m256i control_range = _mm256_set1_epi8('\r' - '\t');
+			const __m256i zero = _mm256_setzero_si256();
+
+			while (len >= 32) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + len - 32));
+
+				// '\t' to '\r' are recognized by an unsigned comparison of the distance from '\t'
+				const __m256i control = _mm256_sub_epi8(v, tab);
+				const __m256i blank = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, zero)),
+					_mm256_cmpeq_epi8(_mm256_min_epu8(control, control_range), control));
+
+				const auto non_blank = ~static_cast<uint32_t>(_mm256_movemask_epi8(blank));
+				if (non_blank != 0) {
+					return len - static_cast<size_t>(std::countl_zero(non_blank));
+				}
+				len -= 32;
+			}
+
+			return Trimmed_Length_Scalar(str, len);
+		}
+
+#elif defined(XPTLIB_SIMD_NEON)
+
+		// scans the string backwards by 16 bytes, looking for the last non-blank byte
+		inline size_t Trimmed_Length_NEON(const char* str, size_t len) {
+
+			const uint8x16_t space = vdupq_n_u8(' ');
+			const uint8x16_t tab = vdupq_n_u8('\t');
+			const uint8x16_t control_range = vdupq_n_u8('\r' - '\t');
+
+			while (len >= 16) {
+				const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(str + len - 16));
+
+				const uint8x16_t blank = vorrq_u8(
+					vorrq_u8(vceqq_u8(v, space), vceqzq_u8(v)),
+					vcleq_u8(vsubq_u8(v, tab), control_range));
+
+				// narrow the byte mask to 4 bits per byte, so it fits to a 64-bit integer
+				const uint64_t non_blank = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(blank), 4)), 0);
+				if (non_blank != 0) {
+					return len - static_cast<size_t>(std::countl_zero(non_blank) / 4);
+				}
+				len -= 16;
+			}
+
+			return Trimmed_Length_Scalar(str, len);
+		}
+
+#endif
+
+		using Trimmed_Length_Kernel = size_t(*)(const char*, size_t);
+
+		// selects the fastest trimming kernel supported by the machine
+		inline Trimmed_Length_Kernel Select_Trimmed_Length_Kernel() {
+#if defined(XPTLIB_SIMD_X86)
+			if (Detect_Cpu_Features().avx2) {
+				return Trimmed_Length_AVX2;
+			}
+#elif defined(XPTLIB_SIMD_NEON)
+			return Trimmed_Length_NEON;
+#endif
+			return Trimmed_Length_Scalar;
+		}
+
+		/**
+		 * Determines the length of the string after trimming trailing blanks and NULs
+		 * Values filling the whole field and short fields are resolved inline, wider fields are scanned by the SIMD kernel chosen at runtime
+		 */
+		inline size_t Trimmed_Length(const char* str, size_t len) {
+			if (len == 0 || !Is_Trailing_Blank(str[len - 1])) {
+				return len;
+			}
+			if (len < 32) {
+				return Trimmed_Length_Scalar(str, len - 1);
+			}
+
+			static const Trimmed_Length_Kernel kernel = Select_Trimmed_Length_Kernel();
+			return kernel(str, len - 1);
+		}
+
+		/**
+		 * Trims a string field of given length of blanks (and trailing NULs); the result points directly to the field
+		 */
+		inline std::string_view Trim_View(const char* str, size_t len) {
+			const char* end = str + Trimmed_Length(str, len);
+			while (str != end && Is_Blank(*str)) {
+				str++;
+			}
+
+			return std::string_view{ str, static_cast<size_t>(end - str) };
+		}
+
+		/**
+		 * Retrieves a string view pointing directly to the buffer, trimmed of blanks (and trailing NULs)
+		 * The view is valid only as long as the buffer contents are not modified
+		 */
+		inline std::string_view Get_View_From_Buffer(std::span<const std::byte> buf, const size_t offset, const size_t len) {
+			return Trim_View(reinterpret_cast<const char*>(buf.data() + offset), len);
+		}
+
+		/**
+		 * Retrieves a string from buffer
+		 */
+		inline std::string Get_From_Buffer(std::span<const std::byte> buf, const size_t offset, const size_t len) {
+			return std::string{ Get_View_From_Buffer(buf, offset, len) };
+		}
+
+		// summary of a block of numeric values, as computed by the Summarize kernels; NaNs (missing values) are skipped
+		struct Value_Summary {
+			size_t count = 0;										// count of non-missing values
+			double sum = 0.0;
+			double min = std::numeric_limits<double>::infinity();
+			double max = -std::numeric_limits<double>::infinity();
+			double m2 = 0.0;										// sum of squared deviations from the mean of the block
+		};
+
+		// the mean is computed in the first pass, and the deviations from it in the second one, which is numerically stable for the block
+		inline void Summarize_Scalar(const double* in, size_t n, Value_Summary& out) {
+			Value_Summary summary;
+			for (size_t i = 0; i < n; i++) {
+				const double v = in[i];
+				if (v == v) {
+					summary.count++;
+					summary.sum += v;
+					summary.min = std::min(summary.min, v);
+					summary.max = std::max(summary.max, v);
+				}
+			}
+
+			const double mean = summary.count != 0 ? summary.sum / static_cast<double>(summary.count) : 0.0;
+			for (size_t i = 0; i < n; i++) {
+				const double v = in[i];
+				if (v == v) {
+					summary.m2 += (v - mean) * (v - mean);
+				}
+			}
+
+			out = summary;
+		}
+
+#if defined(XPTLIB_SIMD_X86)
+
+		XPTLIB_TARGET_AVX2
+		inline double Horizontal_Sum_AVX2(__m256d v) {
+			const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+		}
+
+		XPTLIB_TARGET_AVX2
+		inline void Summarize_AVX2(const double* in, size_t n, Value_Summary& out) {
+
+			const __m256d infinity = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+			const __m256d neg_infinity = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+
+			__m256i count = _mm256_setzero_si256();
+			__m256d sum = _mm256_setzero_pd();
+			__m256d min = infinity;
+			__m256d max = neg_infinity;
+
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				const __m256d v = _mm256_loadu_pd(in + i);
+				const __m256d valid = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+
+				// the mask is all ones (-1) for valid values
+				count = _mm256_sub_epi64(count, _mm256_castpd_si256(valid));
+				sum = _mm256_add_pd(sum, _mm256_and_pd(v, valid));
+				min = _mm256_min_pd(min, _mm256_blendv_pd(infinity, v, valid));
+				max = _mm256_max_pd(max, _mm256_blendv_pd(neg_infinity, v, valid));
+			}
+
+			alignas(32) std::array<uint64_t, 4> counts;
+			alignas(32) std::array<double, 4> mins, maxs;
+			_mm256_store_si256(reinterpret_cast<__m256i*>(counts.data()), count);
+			_mm256_store_pd(mins.data(), min);
+			_mm256_store_pd(maxs.data(), max);
+
+			Value_Summary summary;
+			Summarize_Scalar(in + i, n - i, summary);
+			summary.sum += Horizontal_Sum_AVX2(sum);
+			for (size_t j = 0; j < 4; j++) {
+				summary.count += counts[j];
+				summary.min = std::min(summary.min, mins[j]);
+				summary.max = std::max(summary.max, maxs[j]);
+			}
+
+			// second pass - deviations from the mean of the whole block
+			const double mean = summary.count != 0 ? summary.sum / static_cast<double>(summary.count) : 0.0;
+			const __m256d mean_v = _mm256_set1_pd(mean);
+			__m256d m2 = _mm256_setzero_pd();
+
+			i = 0;
+			for (; i + 4 <= n; i += 4) {
+				const __m256d v = _mm256_loadu_pd(in + i);
+				const __m256d deviation = _mm256_and_pd(_mm256_sub_pd(v, mean_v), _mm256_cmp_pd(v, v, _CMP_ORD_Q));
+				m2 = _mm256_add_pd(m2, _mm256_mul_pd(deviation, deviation));
+			}
+
+			summary.m2 = Horizontal_Sum_AVX2(m2);
+			for (; i < n; i++) {
+				if (in[i] == in[i]) {
+					summary.m2 += (in[i] - mean) * (in[i] - mean);
+				}
+			}
+
+			out = summary;
+		}
+
+#elif defined(XPTLIB_SIMD_NEON)
+
+		inline void Summarize_NEON(const double* in, size_t n, Value_Summary& out) {
+
+			const float64x2_t infinity = vdupq_n_f64(std::numeric_limits<double>::infinity());
+			const float64x2_t neg_infinity = vdupq_n_f64(-std::numeric_limits<double>::infinity());
+
+			uint64x2_t count = vdupq_n_u64(0);
+			float64x2_t sum = vdupq_n_f64(0.0);
+			float64x2_t min = infinity;
+			float64x2_t max = neg_infinity;
+
+			size_t i = 0;
+			for (; i + 2 <= n; i += 2) {
+				const float64x2_t v = vld1q_f64(in + i);
+				const uint64x2_t valid = vceqq_f64(v, v);
+
+				count = vsubq_u64(count, valid);
+				sum = vaddq_f64(sum, vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(v), valid)));
+				min = vminq_f64(min, vbslq_f64(valid, v, infinity));
+				max = vmaxq_f64(max, vbslq_f64(valid, v, neg_infinity));
+			}
+
+			Value_Summary summary;
+			Summarize_Scalar(in + i, n - i, summary);
+			summary.count += static_cast<size_t>(vaddvq_u64(count));
+			summary.sum += vaddvq_f64(sum);
+			summary.min = std::min(summary.min, vminvq_f64(min));
+			summary.max = std::max(summary.max, vmaxvq_f64(max));
+
+			// second pass - deviations from the mean of the whole block
+			const double mean = summary.count != 0 ? summary.sum / static_cast<double>(summary.count) : 0.0;
+			const float64x2_t mean_v = vdupq_n_f64(mean);
+			float64x2_t m2 = vdupq_n_f64(0.0);
+
+			i = 0;
+			for (; i + 2 <= n; i += 2) {
+				const float64x2_t v = vld1q_f64(in + i);
+				const float64x2_t deviation = vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(vsubq_f64(v, mean_v)), vceqq_f64(v, v)));
+				m2 = vfmaq_f64(m2, deviation, deviation);
+			}
+
+			summary.m2 = vaddvq_f64(m2);
+			for (; i < n; i++) {
+				if (in[i] == in[i]) {
+					summary.m2 += (in[i] - mean) * (in[i] - mean);
+				}
+			}
+
+			out = summary;
+		}
+
+#endif
+
+		using Summarize_Kernel = void(*)(const double*, size_t, Value_Summary&);
+
+		// selects the fastest summary kernel supported by the machine
+		inline Summarize_Kernel Select_Summarize_Kernel() {
+#if defined(XPTLIB_SIMD_X86)
+			if (Detect_Cpu_Features().avx2) {
+				return Summarize_AVX2;
+			}
+#elif defined(XPTLIB_SIMD_NEON)
+			return Summarize_NEON;
+#endif
+			return Summarize_Scalar;
+		}
+
+		/**
+		 * Computes the count, sum, minimum, maximum and the sum of squared deviations of n values; NaNs (missing values) are skipped
+		 * The implementation is chosen at runtime according to the instruction sets supported by the CPU
+		 */
+		inline void Summarize(const double* in, size_t n, Value_Summary& out) {
+			static const Summarize_Kernel kernel = Select_Summarize_Kernel();
+			kernel(in, n, out);
+		}
+
+		/**
+		 * Computes the 64-bit FNV-1a hash of the bytes
+		 */
+		inline uint64_t Hash_Bytes(std::string_view str) {
+			uint64_t hash = 0xcbf29ce484222325ULL;
+			for (const char ch : str) {
+				hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3ULL;
+			}
+			return hash;
+		}
+	}
+
+	enum class NStatus {
+		Ok,
+		No_Library_Header,
+		No_Member_Header,
+		No_Descriptor_Header,
+		No_Namestr_Header,
+		No_Observation_Header,
+		No_Such_Variable,
+		Unexpected_EOF,
+		Type_Mismatch,
+		Invalid_Variable,
+		Write_Error,
+		No_Such_Member,
+		Invalid_Index,
+	};
+
+	// universal transport variant used to export value from internal representation
+	using TValue = std::variant<std::string, double>;
+
+	// non-owning variant of TValue; strings point directly to the internal row buffer of xpt::File and are valid only until the next read
+	using TValue_View = std::variant<std::string_view, double>;
+
+	/**
+	 * Bump allocator of strings; the strings are stored to large blocks, and are all released at once by Reset
+	 * The blocks are kept for reuse, so refilling the arena after a reset does not allocate
+	 */
+	class String_Arena {
+		private:
+			struct Block {
+				std::unique_ptr<char[]> data;
+				size_t size = 0;
+			};
+
+			// allocated blocks, the ones after mCurrent are unused (since the last reset)
+			std::vector<Block> mBlocks;
+
+			// index of the block being filled, and the count of bytes used in it
+			size_t mCurrent = 0;
+			size_t mUsed = 0;
+
+			// size of newly allocated blocks
+			size_t mBlock_Size;
+
+			// moves to the next block with at least a given size, allocating it if needed
+			void Next_Block(size_t min_size) {
+				while (mCurrent + 1 < mBlocks.size()) {
+					mCurrent++;
+					mUsed = 0;
+					if (mBlocks[mCurrent].size >= min_size) {
+						return;
+					}
+				}
+
+				const size_t size = std::max(mBlock_Size, min_size);
+				mBlocks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+				mCurrent = mBlocks.size() - 1;
+				mUsed = 0;
+			}
+
+		public:
+			explicit String_Arena(size_t block_size = 64 * 1024) : mBlock_Size(std::max<size_t>(block_size, 1)) {
+			}
+
+			/**
+			 * Copies the string to the arena; the result is valid until the arena is reset or destroyed
+			 */
+			std::string_view Store(std::string_view str) {
+				if (str.empty()) {
+					return {};
+				}
+				if (mBlocks.empty() || mUsed + str.size() > mBlocks[mCurrent].size) {
+					Next_Block(str.size());
+				}
+
+				char* target = mBlocks[mCurrent].data.get() + mUsed;
+				std::memcpy(target, str.data(), str.size());
+				mUsed += str.size();
+
+				return std::string_view{ target, str.size() };
+			}
+
+			/**
+			 * Releases all the strings stored; the memory is kept for reuse
+			 */
+			void Reset() {
+				mCurrent = 0;
+				mUsed = 0;
+			}
+
+			/**
+			 * Retrieves the count of bytes allocated by the arena
+			 */
+			size_t Capacity() const {
+				size_t capacity = 0;
+				for (const auto& block : mBlocks) {
+					capacity += block.size;
+				}
+				return capacity;
+			}
+	};
+
+	/**
+	 * Compact (16 bytes) non-owning value of a cell - either a number, or a string pointing to the memory owned by someone else
+	 * (typically xpt::String_Arena, see File::Read_Next and File::Read_Rows)
+	 */
+	class Cell {
+		private:
+			union {
+				double mNumber = 0.0;
+				const char* mString;
+			};
+
+			// length of the string value
+			uint32_t mLength = 0;
+
+			bool mIs_String = false;
+
+		public:
+			Cell() = default;
+
+			Cell(double number) : mNumber(number) {
+			}
+
+			Cell(std::string_view str) : mString(str.data()), mLength(static_cast<uint32_t>(str.size())), mIs_String(true) {
+			}
+
+			bool Is_String() const {
+				return mIs_String;
+			}
+
+			bool Is_Number() const {
+				return !mIs_String;
+			}
+
+			// retrieves the numeric value (numeric cells only)
+			double Number() const {
+				return mNumber;
+			}
+
+			// retrieves the string value (string cells only)
+			std::string_view String() const {
+				return std::string_view{ mString, mLength };
+			}
+
+			// converts the cell to the non-owning variant
+			TValue_View View() const {
+				if (mIs_String) {
+					return String();
+				}
+				return mNumber;
+			}
+	};
+
+	static_assert(sizeof(Cell) == 16, "xpt::Cell is expected to fit to 16 bytes");
+
+	/**
+	 * Block of rows decoded to cells, filled by File::Read_Rows; the cells of all rows are stored in a single vector (row by row),
+	 * and the strings in the block's own arena, so the whole block is released at once by Clear
+	 */
+	struct Row_Block {
+		size_t columns = 0;			// count of cells of a row
+		size_t rows = 0;			// count of rows stored
+		std::vector<Cell> cells;	// cells of all rows, row by row
+		String_Arena arena;			// storage of string values
+
+		// retrieves the cells of a given row
+		std::span<const Cell> Row(size_t row) const {
+			return std::span<const Cell>{ cells }.subspan(row * columns, columns);
+		}
+
+		// releases all the rows; the memory is kept for reuse
+		void Clear() {
+			rows = 0;
+			cells.clear();
+			arena.Reset();
+		}
+	};
+
+	/**
+	 * Retrieves the SAS missing value code ('.', '_' or 'A' to 'Z') of a numeric value, or '\0' if the value is not missing
+	 * Missing values are read as NaNs carrying the code; any other NaN is considered the "." missing value
+	 */
+	inline char Missing_Code(double value) {
+		const auto bits = std::bit_cast<uint64_t>(value);
+		const bool is_nan = (bits & 0x7ff0000000000000ULL) == 0x7ff0000000000000ULL && (bits & 0x000fffffffffffffULL) != 0;
+		if (!is_nan) {
+			return '\0';
+		}
+
+		const auto code = bits & 0xffULL;
+		return internal::Is_Missing_Code(code) ? static_cast<char>(code) : '.';
+	}
+
+	/**
+	 * Creates a NaN representing the SAS missing value of a given code ('.', '_' or 'A' to 'Z'); the code is preserved when written by xpt::Writer
+	 */
+	inline double Missing_Value(char code = '.') {
+		const auto raw_code = static_cast<uint64_t>(static_cast<unsigned char>(code));
+		return std::bit_cast<double>(internal::Ieee_Missing_Value | (internal::Is_Missing_Code(raw_code) ? raw_code : '.'));
+	}
+
+	/**
+	 * Dictionary of distinct string values, assigning consecutive codes (from zero) to the values in the order they are interned
+	 */
+	class String_Dictionary {
+		private:
+			// concatenated values; value of code i is stored in bytes [mOffsets[i], mOffsets[i+1])
+			std::vector<char> mBytes;
+			std::vector<uint32_t> mOffsets{ 0 };
+
+			// hashes of the values, by code
+			std::vector<uint64_t> mHashes;
+
+			// open-addressing hash table of codes + 1 (0 is an empty slot); the size is a power of two, and at most half of it is used
+			std::vector<uint32_t> mSlots;
+
+			// inserts the code to the hash table, which must have a free slot
+			void Insert_Slot(uint32_t code) {
+				const size_t mask = mSlots.size() - 1;
+				for (size_t slot = mHashes[code] & mask; ; slot = (slot + 1) & mask) {
+					if (mSlots[slot] == 0) {
+						mSlots[slot] = code + 1;
+						return;
+					}
+				}
+			}
+
+		public:
+			/**
+			 * Retrieves the code of the value, adding it to the dictionary if it is not there yet
+			 */
+			uint32_t Intern(std::string_view value) {
+				const uint64_t hash = internal::Hash_Bytes(value);
+
+				if (!mSlots.empty()) {
+					const size_t mask = mSlots.size() - 1;
+					for (size_t slot = hash & mask; mSlots[slot] != 0; slot = (slot + 1) & mask) {
+						const uint32_t code = mSlots[slot] - 1;
+						if (mHashes[code] == hash && Value(code) == value) {
+							return code;
+						}
+					}
+				}
+
+				const auto code = static_cast<uint32_t>(mHashes.size());
+				mBytes.insert(mBytes.end(), value.begin(), value.end());
+				mOffsets.push_back(static_cast<uint32_t>(mBytes.size()));
+				mHashes.push_back(hash);
+
+				// keep the load factor at most 1/2, so the probe sequences stay short
+				if (mHashes.size() * 2 > mSlots.size()) {
+					mSlots.assign(std::max<size_t>(16, mSlots.size() * 2), 0);
+					for (uint32_t i = 0; i < mHashes.size(); i++) {
+						Insert_Slot(i);
+					}
+				}
+				else {
+					Insert_Slot(code);
+				}
+
+				return code;
+			}
+
+			// retrieves the value of a given code; valid until the next Intern
+			std::string_view Value(uint32_t code) const {
+				return std::string_view{ mBytes.data() + mOffsets[code], static_cast<size_t>(mOffsets[code + 1] - mOffsets[code]) };
+			}
+
+			// retrieves the count of distinct values
+			size_t Size() const {
+				return mHashes.size();
+			}
+
+			// retrieves the concatenated values
+			std::span<const char> Bytes() const {
+				return mBytes;
+			}
+
+			// retrieves the offsets of the values (count of values + 1 entries)
+			std::span<const uint32_t> Offsets() const {
+				return mOffsets;
+			}
+
+			// removes all the values
+			void Clear() {
+				mBytes.clear();
+				mOffsets.assign(1, 0);
+				mHashes.clear();
+				mSlots.clear();
+			}
+	};
+
+	/**
+	 * Columnar block of rows, filled by File::Read_Batch
+	 * The storage of all columns is reused when the batch is filled again, so repeated reads into the same batch do not allocate
+	 */
+	struct Column_Batch {
+
+		// a single column of the batch; depending on the variable type, either numeric values, or string offsets and bytes are filled
+		struct Column {
+			size_t variable = 0;							// index of the variable in File::Get_Variable_Vector
+			NVar_Type type = NVar_Type::Numeric;
+
+			std::vector<double> numbers;					// numeric values, one per row (missing values are NaNs)
+			std::vector<uint8_t> validity;					// numeric columns: validity bitmap, bit (row % 8) of byte (row / 8) is set for non-missing values
+			std::vector<char> missing;						// numeric columns: missing value code ('.', '_' or 'A' to 'Z') of each row, '\0' for non-missing values
+			size_t missing_count = 0;						// numeric columns: count of missing values
+			std::vector<uint32_t> offsets;					// string offsets - row count + 1 entries, string of row i is stored in bytes [offsets[i], offsets[i+1])
+			std::vector<char> bytes;						// concatenated trimmed strings of all rows
+
+			// lazy string columns (see File::Set_Lazy_Strings): untrimmed fields are left in the data read from the file, offsets and bytes are empty
+			const char* fields = nullptr;					// field of the first row, or nullptr if the strings are materialized
+			size_t field_stride = 0;						// distance of fields of consecutive rows (the record length)
+			size_t field_length = 0;						// length of a single field
+
+			// dictionary-encoded string columns (see File::Set_Dictionary_Encoding): code of the value of each row, offsets and bytes are empty
+			// the dictionary is kept when the batch is filled again, so the codes are the same in all batches read to the same batch object
+			bool dictionary_encoded = false;
+			std::vector<uint32_t> codes;
+			String_Dictionary dictionary;
+
+			// retrieves the string value of a given row (string columns only); lazy values are trimmed on access
+			std::string_view String(size_t row) const {
+				if (dictionary_encoded) {
+					return dictionary.Value(codes[row]);
+				}
+				if (fields) {
+					return internal::Trim_View(fields + row * field_stride, field_length);
+				}
+				return std::string_view{ bytes.data() + offsets[row], static_cast<size_t>(offsets[row + 1] - offsets[row]) };
+			}
+
+			// are the strings left in the data read from the file? (string columns only)
+			bool Is_Lazy() const {
+				return fields != nullptr;
+			}
+
+			// copies the trimmed strings of a lazy column to its own storage, so they remain valid after the next read; rows is the row count of the batch
+			void Materialize(size_t rows) {
+				if (!fields) {
+					return;
+				}
+
+				offsets.resize(rows + 1);
+				bytes.resize(rows * field_length);
+
+				uint32_t offset = 0;
+				for (size_t r = 0; r < rows; r++) {
+					const auto view = String(r);
+					offsets[r] = offset;
+					std::copy(view.begin(), view.end(), bytes.begin() + offset);
+					offset += static_cast<uint32_t>(view.size());
+				}
+				offsets[rows] = offset;
+				bytes.resize(offset);
+
+				fields = nullptr;
+			}
+
+			// is the value of a given row missing? (numeric columns only)
+			bool Is_Missing(size_t row) const {
+				return (validity[row / 8] & (1 << (row % 8))) == 0;
+			}
+		};
+
+		// count of rows stored in this batch
+		size_t rows = 0;
+
+		// columns of this batch
+		std::vector<Column> columns;
+
+		// is the batch filtered (see File::Set_Filter)? The columns then contain all the rows read, and selection contains the indices
+		// of the rows meeting the filter, in ascending order; the strings of other rows are left empty
+		bool filtered = false;
+		std::vector<uint32_t> selection;
+
+		// retrieves the count of rows meeting the filter (all rows, if the batch is not filtered)
+		size_t Selected_Rows() const {
+			return filtered ? selection.size() : rows;
+		}
+
+		// appends the rows of another batch with the same columns (e.g., read from another file); only the rows meeting the filter
+		// are appended from a filtered batch, and the strings are copied. This batch must not be filtered, lazy nor dictionary-encoded
+		void Append(const Column_Batch& other) {
+
+			// an empty batch takes the columns of the other batch
+			if (rows == 0) {
+				columns.resize(other.columns.size());
+				for (size_t i = 0; i < columns.size(); i++) {
+					auto& col = columns[i];
+					col.variable = other.columns[i].variable;
+					col.type = other.columns[i].type;
+					col.numbers.clear();
+					col.validity.clear();
+					col.missing.clear();
+					col.missing_count = 0;
+					col.offsets.assign(1, 0);
+					col.bytes.clear();
+					col.fields = nullptr;
+					col.dictionary_encoded = false;
+					col.codes.clear();
+				}
+				filtered = false;
+				selection.clear();
+			}
+
+			const size_t count = other.Selected_Rows();
+			auto row_at = [&other](size_t k) -> size_t {
+				return other.filtered ? other.selection[k] : k;
+			};
+
+			for (size_t i = 0; i < columns.size(); i++) {
+				auto& col = columns[i];
+				const auto& src = other.columns[i];
+
+				if (col.type == NVar_Type::Numeric) {
+					// bits past the last row are cleared, so the appended rows can be just or-ed in
+					col.validity.resize((rows + 7) / 8);
+					if (rows % 8 != 0) {
+						col.validity.back() &= static_cast<uint8_t>((1 << (rows % 8)) - 1);
+					}
+					col.validity.resize((rows + count + 7) / 8, 0);
+
+					for (size_t k = 0; k < count; k++) {
+						const size_t row = row_at(k);
+						const size_t pos = rows + k;
+						col.numbers.push_back(src.numbers[row]);
+						col.missing.push_back(src.missing[row]);
+						if (src.missing[row] == '\0') {
+							col.validity[pos / 8] |= static_cast<uint8_t>(1 << (pos % 8));
+						}
+						else {
+							col.missing_count++;
+						}
+					}
+				}
+				else {
+					for (size_t k = 0; k < count; k++) {
+						const auto str = src.String(row_at(k));
+						col.bytes.insert(col.bytes.end(), str.begin(), str.end());
+						col.offsets.push_back(static_cast<uint32_t>(col.bytes.size()));
+					}
+				}
+			}
+
+			rows += count;
+		}
+
+		// materializes all lazy string columns of the batch (see Column::Materialize)
+		void Materialize() {
+			for (auto& col : columns) {
+				col.Materialize(rows);
+			}
+		}
+
+		// removes the rows not meeting the filter from a filtered batch, so the columns contain just the selected rows (and the batch is not filtered)
+		void Compact() {
+			if (!filtered) {
+				return;
+			}
+
+			const size_t count = selection.size();
+			for (auto& col : columns) {
+				if (col.type == NVar_Type::Numeric) {
+					col.missing_count = 0;
+					std::fill(col.validity.begin(), col.validity.end(), uint8_t{ 0 });
+					for (size_t k = 0; k < count; k++) {
+						const size_t row = selection[k];
+						col.numbers[k] = col.numbers[row];
+						col.missing[k] = col.missing[row];
+						col.missing_count += col.missing[k] != '\0' ? 1 : 0;
+						col.validity[k / 8] |= static_cast<uint8_t>((col.missing[k] == '\0' ? 1 : 0) << (k % 8));
+					}
+					col.numbers.resize(count);
+					col.missing.resize(count);
+					col.validity.resize((count + 7) / 8);
+				}
+				else if (col.dictionary_encoded) {
+					for (size_t k = 0; k < count; k++) {
+						col.codes[k] = col.codes[selection[k]];
+					}
+					col.codes.resize(count);
+				}
+				else {
+					std::vector<uint32_t> offsets(count + 1);
+					std::vector<char> bytes;
+					for (size_t k = 0; k < count; k++) {
+						const auto str = col.String(selection[k]);
+						offsets[k] = static_cast<uint32_t>(bytes.size());
+						bytes.insert(bytes.end(), str.begin(), str.end());
+					}
+					offsets[count] = static_cast<uint32_t>(bytes.size());
+
+					col.offsets = std::move(offsets);
+					col.bytes = std::move(bytes);
+					col.fields = nullptr;
+				}
+			}
+
+			rows = count;
+			filtered = false;
+			selection.clear();
+		}
+	};
+
+	/**
+	 * Abstract source of XPT file contents; xpt::File reads all the data through this interface
+	 */
+	class Input_Source {
+		public:
+			virtual ~Input_Source() = default;
+
+			// reads up to count bytes to the target memory; returns the count of bytes actually read
+			virtual size_t Read(std::byte* target, size_t count) = 0;
+
+			// discards a given count of bytes
+			virtual void Skip(size_t count) = 0;
+
+			// retrieves a view of next count bytes; the view points either directly to the memory of the source (if it is memory-backed), or
+			// to the supplied scratch buffer. The view is shorter than requested, if an EOF occurred
+			virtual std::span<const std::byte> Fetch(size_t count, std::vector<std::byte>& scratch) {
+				if (scratch.size() < count) {
+					scratch.resize(count);
+				}
+				return { scratch.data(), Read(scratch.data(), count) };
+			}
+
+			// retrieves the current position in the source
+			virtual size_t Tell() const = 0;
+
+			// moves to the given absolute position; returns false if the source does not support seeking
+			virtual bool Seek(size_t /*position*/) {
+				return false;
+			}
+
+			// retrieves the total size of the source in bytes, or 0 if it is not known
+			virtual size_t Size() const {
+				return 0;
+			}
+
+			// creates an independent source of the same contents (with its own position), e.g., for use by other threads;
+			// returns nullptr if the source cannot be duplicated
+			virtual std::unique_ptr<Input_Source> Clone() const {
+				return nullptr;
+			}
+	};
+
+	namespace internal {
+
+		/**
+		 * Input source reading from a file through standard file stream
+		 */
+		class Stream_Source : public Input_Source {
+			private:
+				std::filesystem::path mPath;
+				std::ifstream mFile;
+				size_t mPosition = 0;
+				size_t mSize = 0;
+
+			public:
+				bool Open(const std::filesystem::path& path) {
+					mFile.open(path, std::ios::in | std::ios::binary);
+					if (!mFile.is_open()) {
+						return false;
+					}
+
+					std::error_code ec;
+					mPath = path;
+					mSize = static_cast<size_t>(std::filesystem::file_size(path, ec));
+					if (ec) {
+						mSize = 0;
+					}
+
+					return true;
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					mFile.read(reinterpret_cast<char*>(target), static_cast<std::streamsize>(count));
+					const auto cnt = static_cast<size_t>(mFile.gcount());
+					mPosition += cnt;
+					return cnt;
+				}
+
+				void Skip(size_t count) override {
+					mFile.seekg(static_cast<std::streamoff>(count), std::ios::cur);
+					mPosition += count;
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					mFile.clear();
+					mFile.seekg(static_cast<std::streamoff>(position), std::ios::beg);
+					mPosition = position;
+					return !mFile.fail();
+				}
+
+				size_t Size() const override {
+					return mSize;
+				}
+
+				std::unique_ptr<Input_Source> Clone() const override {
+					auto source = std::make_unique<Stream_Source>();
+					if (!source->Open(mPath)) {
+						return nullptr;
+					}
+					return source;
+				}
+		};
+
+		// source reading from a stream supplied by the user (not owned); positions are relative to the stream position when the source was created
+		class Istream_Source : public Input_Source {
+			private:
+				std::istream& mStream;
+				std::streamoff mBase = 0;
+				size_t mPosition = 0;
+				size_t mSize = 0;
+				bool mSeekable = false;
+
+			public:
+				Istream_Source(std::istream& stream) : mStream(stream) {
+					// determine the size of the remaining contents, if the stream supports seeking
+					const auto base = mStream.tellg();
+					if (base != std::streampos(-1) && mStream.seekg(0, std::ios::end)) {
+						const auto end = mStream.tellg();
+						if (end != std::streampos(-1) && mStream.seekg(base)) {
+							mBase = static_cast<std::streamoff>(base);
+							mSize = static_cast<size_t>(end - base);
+							mSeekable = true;
+						}
+					}
+					mStream.clear();
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					mStream.read(reinterpret_cast<char*>(target), static_cast<std::streamsize>(count));
+					const auto cnt = static_cast<size_t>(mStream.gcount());
+					mPosition += cnt;
+					return cnt;
+				}
+
+				void Skip(size_t count) override {
+					mStream.ignore(static_cast<std::streamsize>(count));
+					mPosition += static_cast<size_t>(mStream.gcount());
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					if (!mSeekable) {
+						return false;
+					}
+
+					// the position is kept unless the stream was actually moved
+					mStream.clear();
+					if (!mStream.seekg(mBase + static_cast<std::streamoff>(position), std::ios::beg)) {
+						mStream.clear();
+						return false;
+					}
+					mPosition = position;
+					return true;
+				}
+
+				size_t Size() const override {
+					return mSize;
+				}
+		};
+
+		/**
+		 * Input source working directly on a contiguous block of memory; the data are not copied when fetched
+		 * The optional owner object keeps the memory alive (it is shared by all clones of the source)
+		 */
+		class Memory_Source : public Input_Source {
+			private:
+				std::shared_ptr<const void> mOwner;
+				std::span<const std::byte> mData;
+				size_t mPosition = 0;
+
+			public:
+				Memory_Source(std::span<const std::byte> data, std::shared_ptr<const void> owner = nullptr)
+					: mOwner(std::move(owner)), mData(data) {
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					const size_t avail = std::min(count, mData.size() - mPosition);
+					std::memcpy(target, mData.data() + mPosition, avail);
+					mPosition += avail;
+					return avail;
+				}
+
+				void Skip(size_t count) override {
+					mPosition += std::min(count, mData.size() - mPosition);
+				}
+
+				std::span<const std::byte> Fetch(size_t count, std::vector<std::byte>&) override {
+					const size_t avail = std::min(count, mData.size() - mPosition);
+					const auto result = mData.subspan(mPosition, avail);
+					mPosition += avail;
+					return result;
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					mPosition = std::min(position, mData.size());
+					return true;
+				}
+
+				size_t Size() const override {
+					return mData.size();
+				}
+
+				std::unique_ptr<Input_Source> Clone() const override {
+					return std::make_unique<Memory_Source>(mData, mOwner);
+				}
+		};
+
+#if defined(XPTLIB_HAS_MMAP)
+
+		/**
+		 * Read-only memory mapping of a whole file
+		 */
+		class Memory_Mapping {
+			private:
+				const std::byte* mData = nullptr;
+				size_t mSize = 0;
+
+#if defined(_WIN32)
+				HANDLE mMapping = nullptr;
+#endif
+
+			public:
+				Memory_Mapping() = default;
+				Memory_Mapping(const Memory_Mapping&) = delete;
+				Memory_Mapping& operator=(const Memory_Mapping&) = delete;
+
+				~Memory_Mapping() {
+#if defined(_WIN32)
+					if (mData) {
+						UnmapViewOfFile(mData);
+					}
+					if (mMapping) {
+						CloseHandle(mMapping);
+					}
+#else
+					if (mData) {
+						munmap(const_cast<std::byte*>(mData), mSize);
+					}
+#endif
+				}
+
+				// maps the whole file to memory; returns false on failure
+				bool Open(const std::filesystem::path& path) {
+#if defined(_WIN32)
+					HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+					if (file == INVALID_HANDLE_VALUE) {
+						return false;
+					}
+
+					LARGE_INTEGER size;
+					if (!GetFileSizeEx(file, &size)) {
+						CloseHandle(file);
+						return false;
+					}
+
+					mSize = static_cast<size_t>(size.QuadPart);
+					if (mSize > 0) {
+						mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+						if (mMapping) {
+							mData = static_cast<const std::byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+						}
+					}
+					CloseHandle(file);
+
+					return mSize == 0 || mData != nullptr;
+#else
+					const int fd = ::open(path.c_str(), O_RDONLY);
+					if (fd < 0) {
+						return false;
+					}
+
+					struct stat st;
+					if (fstat(fd, &st) != 0) {
+						::close(fd);
+						return false;
+					}
+
+					mSize = static_cast<size_t>(st.st_size);
+					if (mSize > 0) {
+						void* mem = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+						if (mem != MAP_FAILED) {
+							mData = static_cast<const std::byte*>(mem);
+							// the file is consumed sequentially, let the kernel read ahead aggressively
+							madvise(mem, mSize, MADV_SEQUENTIAL);
+						}
+					}
+					::close(fd);
+
+					return mSize == 0 || mData != nullptr;
+#endif
+				}
+
+				std::span<const std::byte> Data() const {
+					return { mData, mSize };
+				}
+		};
+
+#endif
+
+#if defined(XPTLIB_WITH_ZLIB)
+
+		// source decompressing a gzip file on the fly; seeking backwards restarts the decompression from the beginning of file
+		class Gzip_Source : public Input_Source {
+			private:
+				std::filesystem::path mPath;
+				gzFile mFile = nullptr;
+				size_t mPosition = 0;
+
+			public:
+				Gzip_Source() = default;
+				Gzip_Source(const Gzip_Source&) = delete;
+				Gzip_Source& operator=(const Gzip_Source&) = delete;
+
+				~Gzip_Source() override {
+					if (mFile) {
+						gzclose(mFile);
+					}
+				}
+
+				bool Open(const std::filesystem::path& path) {
+#if defined(_WIN32)
+					mFile = gzopen_w(path.c_str(), "rb");
+#else
+					mFile = gzopen(path.c_str(), "rb");
+#endif
+					if (!mFile) {
+						return false;
+					}
+
+					gzbuffer(mFile, 256 * 1024);
+					mPath = path;
+					return true;
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					size_t total = 0;
+					// gzread takes an unsigned count, so large reads are split
+					while (total < count) {
+						const auto request = static_cast<unsigned>(std::min<size_t>(count - total, 1u << 30));
+						const int cnt = gzread(mFile, target + total, request);
+						if (cnt <= 0) {
+							break;
+						}
+						total += static_cast<size_t>(cnt);
+					}
+
+					mPosition += total;
+					return total;
+				}
+
+				void Skip(size_t count) override {
+					Seek(mPosition + count);
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					const auto result = gzseek(mFile, static_cast<z_off_t>(position), SEEK_SET);
+					if (result < 0) {
+						return false;
+					}
+
+					mPosition = static_cast<size_t>(result);
+					return mPosition == position;
+				}
+
+				std::unique_ptr<Input_Source> Clone() const override {
+					auto source = std::make_unique<Gzip_Source>();
+					if (!source->Open(mPath)) {
+						return nullptr;
+					}
+					return source;
+				}
+		};
+
+#endif
+
+#if defined(XPTLIB_WITH_ZSTD)
+
+		// source decompressing a zstd file on the fly; seeking backwards restarts the decompression from the beginning of file
+		class Zstd_Source : public Input_Source {
+			private:
+				std::filesystem::path mPath;
+				std::ifstream mFile;
+				ZSTD_DStream* mStream = nullptr;
+
+				std::vector<std::byte> mInput;
+				ZSTD_inBuffer mIn{ nullptr, 0, 0 };
+				std::vector<std::byte> mDiscard;
+
+				size_t mPosition = 0;
+				bool mFailed = false;
+
+				// restarts the decompression from the beginning of file
+				bool Rewind() {
+					mFile.clear();
+					mFile.seekg(0, std::ios::beg);
+					ZSTD_DCtx_reset(mStream, ZSTD_reset_session_only);
+					mIn = { mInput.data(), 0, 0 };
+					mPosition = 0;
+					mFailed = false;
+					return !mFile.fail();
+				}
+
+			public:
+				Zstd_Source() = default;
+				Zstd_Source(const Zstd_Source&) = delete;
+				Zstd_Source& operator=(const Zstd_Source&) = delete;
+
+				~Zstd_Source() override {
+					if (mStream) {
+						ZSTD_freeDStream(mStream);
+					}
+				}
+
+				bool Open(const std::filesystem::path& path) {
+					mFile.open(path, std::ios::in | std::ios::binary);
+					if (!mFile.is_open()) {
+						return false;
+					}
+
+					mStream = ZSTD_createDStream();
+					if (!mStream) {
+						return false;
+					}
+
+					mPath = path;
+					mInput.resize(ZSTD_DStreamInSize());
+					return Rewind();
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					ZSTD_outBuffer out{ target, count, 0 };
+
+					while (out.pos < out.size && !mFailed) {
+						// refill the input buffer
+						if (mIn.pos == mIn.size) {
+							mFile.read(reinterpret_cast<char*>(mInput.data()), static_cast<std::streamsize>(mInput.size()));
+							mIn = { mInput.data(), static_cast<size_t>(mFile.gcount()), 0 };
+							if (mIn.size == 0) {
+								break;
+							}
+						}
+
+						if (ZSTD_isError(ZSTD_decompressStream(mStream, &out, &mIn))) {
+							mFailed = true;
+						}
+					}
+
+					mPosition += out.pos;
+					return out.pos;
+				}
+
+				void Skip(size_t count) override {
+					Seek(mPosition + count);
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					if (position < mPosition && !Rewind()) {
+						return false;
+					}
+
+					// the data in between have to be decompressed anyway
+					mDiscard.resize(std::min<size_t>(position - mPosition, 1024 * 1024));
+					while (mPosition < position) {
+						if (Read(mDiscard.data(), std::min(mDiscard.size(), position - mPosition)) == 0) {
+							return false;
+						}
+					}
+
+					return true;
+				}
+
+				std::unique_ptr<Input_Source> Clone() const override {
+					auto source = std::make_unique<Zstd_Source>();
+					if (!source->Open(mPath)) {
+						return nullptr;
+					}
+					return source;
+				}
+		};
+
+#endif
+
+		// source decorator, which reads large chunks of the underlying source ahead in a background thread into a ring of buffers,
+		// so the I/O overlaps with decoding of the data already read; views fetched from a single chunk point directly to the buffer
+		class Prefetch_Source : public Input_Source {
+			private:
+				struct Chunk {
+					std::vector<std::byte> data;
+					size_t size = 0;
+					bool last = false;		// the source has been exhausted with this chunk
+				};
+
+				std::unique_ptr<Input_Source> mSource;
+				const size_t mChunk_Size;
+				std::vector<Chunk> mChunks;
+
+				// count of chunks filled by the worker and released by the reader; the chunk being read is mChunks[mReleased % depth]
+				size_t mFilled = 0;
+				size_t mReleased = 0;
+
+				// reader state - position within the current chunk and the absolute position
+				size_t mChunk_Position = 0;
+				size_t mPosition = 0;
+				bool mExhausted = false;
+
+				bool mStop = false;
+				std::mutex mLock;
+				std::condition_variable mFill_Cond;
+				std::condition_variable mRead_Cond;
+				std::thread mWorker;
+
+				void Worker() {
+					while (true) {
+						std::unique_lock lock{ mLock };
+						mFill_Cond.wait(lock, [this] { return mStop || mFilled - mReleased < mChunks.size(); });
+						if (mStop) {
+							return;
+						}
+
+						// the free chunk is owned by the worker until it is published, so it is filled without holding the lock
+						Chunk& chunk = mChunks[mFilled % mChunks.size()];
+						lock.unlock();
+
+						chunk.size = mSource->Read(chunk.data.data(), mChunk_Size);
+						chunk.last = chunk.size < mChunk_Size;
+
+						lock.lock();
+						mFilled++;
+						mRead_Cond.notify_one();
+						if (chunk.last) {
+							return;
+						}
+					}
+				}
+
+				void Start() {
+					mFilled = 0;
+					mReleased = 0;
+					mChunk_Position = 0;
+					mExhausted = false;
+					mStop = false;
+					mWorker = std::thread(&Prefetch_Source::Worker, this);
+				}
+
+				void Stop() {
+					if (mWorker.joinable()) {
+						{
+							std::lock_guard lock{ mLock };
+							mStop = true;
+						}
+						mFill_Cond.notify_one();
+						mWorker.join();
+					}
+				}
+
+				// retrieves the chunk being read, with at least one unread byte; the chunk read completely is released first
+				// returns nullptr if the source has been exhausted
+				const Chunk* Current() {
+					if (mExhausted) {
+						return nullptr;
+					}
+
+					std::unique_lock lock{ mLock };
+					while (true) {
+						mRead_Cond.wait(lock, [this] { return mFilled > mReleased; });
+
+						const Chunk& chunk = mChunks[mReleased % mChunks.size()];
+						if (mChunk_Position < chunk.size) {
+							return &chunk;
+						}
+						if (chunk.last) {
+							mExhausted = true;
+							return nullptr;
+						}
+
+						mReleased++;
+						mChunk_Position = 0;
+						mFill_Cond.notify_one();
+					}
+				}
+
+			public:
+				Prefetch_Source(std::unique_ptr<Input_Source> source, size_t chunk_size, size_t queue_depth)
+					: mSource(std::move(source)), mChunk_Size(std::max<size_t>(chunk_size, 1)), mChunks(std::max<size_t>(queue_depth, 2)) {
+
+					mPosition = mSource->Tell();
+					for (auto& chunk : mChunks) {
+						chunk.data.resize(mChunk_Size);
+					}
+					Start();
+				}
+
+				~Prefetch_Source() override {
+					Stop();
+				}
+
+				size_t Read(std::byte* target, size_t count) override {
+					size_t copied = 0;
+					while (copied < count) {
+						const Chunk* chunk = Current();
+						if (!chunk) {
+							break;
+						}
+
+						const size_t cnt = std::min(count - copied, chunk->size - mChunk_Position);
+						std::memcpy(target + copied, chunk->data.data() + mChunk_Position, cnt);
+						mChunk_Position += cnt;
+						copied += cnt;
+					}
+
+					mPosition += copied;
+					return copied;
+				}
+
+				void Skip(size_t count) override {
+					while (count > 0) {
+						const Chunk* chunk = Current();
+						if (!chunk) {
+							break;
+						}
+
+						const size_t cnt = std::min(count, chunk->size - mChunk_Position);
+						mChunk_Position += cnt;
+						mPosition += cnt;
+						count -= cnt;
+					}
+				}
+
+				std::span<const std::byte> Fetch(size_t count, std::vector<std::byte>& scratch) override {
+					// the chunk stays valid until the next call, as it is released only when reading past its end
+					const Chunk* chunk = Current();
+					if (chunk && chunk->size - mChunk_Position >= count) {
+						const std::span<const std::byte> view{ chunk->data.data() + mChunk_Position, count };
+						mChunk_Position += count;
+						mPosition += count;
+						return view;
+					}
+
+					return Input_Source::Fetch(count, scratch);
+				}
+
+				size_t Tell() const override {
+					return mPosition;
+				}
+
+				bool Seek(size_t position) override {
+					Stop();
+					const bool result = mSource->Seek(position);
+					mPosition = mSource->Tell();
+					Start();
+					return result;
+				}
+
+				size_t Size() const override {
+					return mSource->Size();
+				}
+
+				std::unique_ptr<Input_Source> Clone() const override {
+					auto source = mSource->Clone();
+					if (!source) {
+						return nullptr;
+					}
+					return std::make_unique<Prefetch_Source>(std::move(source), mChunk_Size, mChunks.size());
+				}
+		};
+
+		// converts the member header of V8 files to the V5 layout; the dataset name is truncated there (the full name is kept separately)
+		inline Member_Header_Record To_Member_Header(const Member_Header_Record_V8& header) {
+			Member_Header_Record result;
+			std::memcpy(result.sas_symbol, header.sas_symbol, sizeof(result.sas_symbol));
+			std::memcpy(result.sas_dsname, header.sas_dsname, sizeof(result.sas_dsname));
+			std::memcpy(result.sasdata, header.sasdata, sizeof(result.sasdata));
+			std::memcpy(result.sasver, header.sasver, sizeof(result.sasver));
+			std::memcpy(result.sas_osname, header.sas_osname, sizeof(result.sas_osname));
+			std::memset(result.blanks, ' ', sizeof(result.blanks));
+			result.created = header.created;
+			return result;
+		}
+
+		// parses the size of the variable descriptor from the member header - 140 bytes, or 136 bytes in files created on VAX/VMS
+		inline size_t Parse_Namestr_Size(const Data_Header_Generic& hdr) {
+			return Parse_Digits(hdr.num6, sizeof(hdr.num6)) == 136 ? 136 : sizeof(Namestr_Record_1) + sizeof(Namestr_Record_2);
+		}
+
+		// parses the count of variables from the namestr header; it is stored in 4 digits in V5 files, and in 6 digits in V8 files
+		inline size_t Parse_Variable_Count(const Data_Header_Generic& hdr, NFormat_Version version) {
+			if (version == NFormat_Version::V8) {
+				return Parse_Digits(reinterpret_cast<const char*>(&hdr) + 54, 6);
+			}
+			return Parse_Digits(hdr.num2, sizeof(hdr.num2));
+		}
+
+		// parses the count of observations from the observation header of V8 files (the field is all zeroes in V5 files); zero if not stated
+		inline size_t Parse_Observation_Count(const Data_Header_Generic& hdr, NFormat_Version version) {
+			if (version != NFormat_Version::V8) {
+				return 0;
+			}
+			return Parse_Digits(reinterpret_cast<const char*>(&hdr) + 48, 30);
+		}
+
+		// parses the count of entries from the header of label records (V8 files)
+		inline size_t Parse_Label_Count(const Data_Header_Generic& hdr) {
+			return Parse_Digits(hdr.num1, sizeof(hdr.num1));
+		}
+
+		// retrieves the name of the variable from its descriptor - the full name in V8 files, or the (up to) 8 characters
+		inline std::string_view Namestr_Name(const Namestr_Record_1& namestr1, const Namestr_Record_2& namestr2, NFormat_Version version) {
+			if (version == NFormat_Version::V8) {
+				const auto name = Trim_View(namestr2.longname, sizeof(namestr2.longname));
+				if (!name.empty()) {
+					return name;
+				}
+			}
+			return Trim_View(namestr1.nname, sizeof(namestr1.nname));
+		}
+
+		// entry of the label records of V8 files - long label of a variable, and long names of its formats (LABELV9 records only)
+		struct Label_Entry {
+			size_t number = 0;				// ordinal number of the variable (see Namestr_Record_1::nvar0)
+			std::string_view name;
+			std::string_view label;
+			std::string_view format;
+			std::string_view informat;
+		};
+
+		// size of the fixed part of the label entry - the variable number and lengths of the following strings
+		constexpr size_t Label_Entry_Header_Size(bool v9) {
+			return v9 ? 5 * sizeof(uint16_t) : 3 * sizeof(uint16_t);
+		}
+
+		// parses the label entry at a given offset; size is set to the size of the entry, or to the size of its fixed part if the buffer
+		// does not contain it whole. Returns false if the buffer is too short
+		inline bool Parse_Label_Entry(std::span<const std::byte> buffer, size_t offset, bool v9, Label_Entry& entry, size_t& size) {
+
+			size = Label_Entry_Header_Size(v9);
+			if (buffer.size() < offset + size) {
+				return false;
+			}
+
+			std::array<size_t, 5> fields{};
+			for (size_t i = 0; i < size / sizeof(uint16_t); i++) {
+				fields[i] = To_Machine_Endian_Raw(Get_From_Buffer<uint16_t>(buffer, offset + i * sizeof(uint16_t)));
+			}
+
+			const size_t header_size = size;
+			size += fields[1] + fields[2] + fields[3] + fields[4];
+			if (buffer.size() < offset + size) {
+				return false;
+			}
+
+			size_t pos = offset + header_size;
+			auto next = [&buffer, &pos](size_t len) {
+				const auto view = Get_View_From_Buffer(buffer, pos, len);
+				pos += len;
+				return view;
+			};
+
+			entry.number = fields[0];
+			entry.name = next(fields[1]);
+			entry.label = next(fields[2]);
+			entry.format = next(fields[3]);
+			entry.informat = next(fields[4]);
+			return true;
+		}
+	}
+
+	/**
+	 * Date and time, as stored in the headers of the file
+	 */
+	struct Date_Time {
+		int year = 0;			// four-digit year; the file stores just two digits, so years 60-99 are considered 19xx, others 20xx
+		unsigned month = 0;		// 1 to 12
+		unsigned day = 0;
+		unsigned hour = 0;
+		unsigned minute = 0;
+		unsigned second = 0;
+
+		// decodes the date and time record ("ddMMMyy:hh:mm:ss"); returns std::nullopt if the record is invalid
+		static std::optional<Date_Time> Decode(const internal::Date_Time_Record& record) {
+			static constexpr std::string_view Months = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+
+			const auto two_digits = [](const char* str) -> std::optional<unsigned> {
+				if (str[0] < '0' || str[0] > '9' || str[1] < '0' || str[1] > '9') {
+					return std::nullopt;
+				}
+				return static_cast<unsigned>((str[0] - '0') * 10 + (str[1] - '0'));
+			};
+
+			char month[sizeof(record.dtmod_month)];
+			// the case is folded in ASCII, regardless of the locale
+			std::transform(std::begin(record.dtmod_month), std::end(record.dtmod_month), month, [](char ch) { return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch; });
+			const size_t month_pos = Months.find(std::string_view{ month, sizeof(month) });
+
+			const auto day = two_digits(record.dtmod_day);
+			const auto year = two_digits(record.dtmod_year);
+			const auto hour = two_digits(record.dtmod_hour);
+			const auto minute = two_digits(record.dtmod_minute);
+			const auto second = two_digits(record.dtmod_second);
+			if (month_pos == std::string_view::npos || month_pos % 3 != 0 || !day || !year || !hour || !minute || !second) {
+				return std::nullopt;
+			}
+
+			Date_Time result;
+			result.year = static_cast<int>(*year) + (*year >= 60 ? 1900 : 2000);
+			result.month = static_cast<unsigned>(month_pos / 3 + 1);
+			result.day = *day;
+			result.hour = *hour;
+			result.minute = *minute;
+			result.second = *second;
+			return result;
+		}
+	};
+
+	/**
+	 * Display or input format of a variable
+	 */
+	struct Variable_Format {
+		std::string name;			// name of the format, e.g. "DATE" or "BEST"; empty if no format is assigned
+		size_t length = 0;			// field length, 0 if unspecified
+		size_t decimals = 0;		// count of decimal places
+	};
+
+	/**
+	 * Descriptor of a variable (column), as read from the file headers
+	 * The basic properties are decoded when reading the headers, formats and other rarely used properties are decoded on demand
+	 * from the raw descriptor ("namestr") records
+	 */
+	struct Variable_Record {
+		std::string name;							// variable name
+		std::string label;							// variable label
+		NVar_Type type;					// numeric or string
+		size_t length;								// length of values in the row, in bytes
+		size_t varNum;								// ordinal number of the variable
+		size_t position;							// offset of values in the row
+		internal::NDecode_Kind decode;				// way of decoding the values (determined from type and length)
+		internal::Namestr_Record_1 namestr{};		// raw descriptor records
+		internal::Namestr_Record_2 namestr_2{};
+		std::string format_name;					// long names of the format and informat (from LABELV9 records of V8 files), empty if not given
+		std::string informat_name;
+
+		// retrieves the display format of the variable
+		Variable_Format Get_Format() const {
+			return {
+				!format_name.empty() ? format_name : internal::Char_To_String(namestr.nform),
+				static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr.nfl)),
+				static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr.nfd))
+			};
+		}
+
+		// retrieves the input format (informat) of the variable
+		Variable_Format Get_Informat() const {
+			return {
+				!informat_name.empty() ? informat_name : internal::Char_To_String(namestr.niform),
+				static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr_2.nifl)),
+				static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr_2.nifd))
+			};
+		}
+
+		// is the value right-justified in the display format? (left-justified otherwise)
+		bool Is_Right_Justified() const {
+			return internal::To_Machine_Endian_Raw(namestr.nfj) == 1;
+		}
+	};
+
+	/**
+	 * Compact metadata of the first member (dataset) of a file, as read by File::Read_Metadata
+	 * All the names and labels are views into a single arena owned by this object, so the metadata may be moved, but not copied;
+	 * when reused for another file, the storage is reused as well
+	 */
+	class Metadata {
+
+		public:
+			// variable descriptor
+			struct Variable {
+				std::string_view name;
+				std::string_view label;
+				NVar_Type type;
+				uint32_t length;
+				uint32_t number;		// ordinal number of the variable
+				uint32_t position;		// offset in the row
+			};
+
+		private:
+			std::vector<char> mArena;
+			std::vector<Variable> mVariables;
+			std::string_view mDataset_Name;
+			std::string_view mDataset_Label;
+			size_t mRecord_Len = 0;
+			size_t mData_Offset = 0;
+
+			// stores a trimmed copy of the field to the arena
+			std::string_view Store(const char* field, size_t len, size_t& arena_used) {
+				const auto view = internal::Get_View_From_Buffer(std::as_bytes(std::span{ field, len }), 0, len);
+				char* dst = mArena.data() + arena_used;
+				std::memcpy(dst, view.data(), view.size());
+				arena_used += view.size();
+				return { dst, view.size() };
+			}
+
+			// parses the headers stored in the buffer; if the buffer is too short, NStatus::Unexpected_EOF is returned, and the required
+			// size of the buffer is stored to the parameter, if it may be determined
+			NStatus Parse(std::span<const std::byte> buffer, size_t& required) {
+
+				// the fixed part - library header (3 records), member and descriptor headers, 2 member records and the namestr header
+				constexpr size_t Namestr_Offset = 8 * 80;
+				required = Namestr_Offset;
+
+				mVariables.clear();
+				mDataset_Name = {};
+				mDataset_Label = {};
+				mRecord_Len = 0;
+				mData_Offset = 0;
+
+				if (buffer.size() < Namestr_Offset) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				const auto header = [&buffer](size_t record) {
+					return internal::Get_From_Buffer<internal::Data_Header_Generic>(buffer, record * 80);
+				};
+				// all the headers must be of the version of the library header
+				auto version = NFormat_Version::V5;
+				internal::Recognize_Signature(std::string_view{ header(0).namedesc, sizeof(header(0).namedesc) }, &version);
+				const auto signature = [version](const internal::Data_Header_Generic& hdr) {
+					return internal::Recognize_Signature(std::string_view{ hdr.namedesc, sizeof(hdr.namedesc) }, version);
+				};
+
+				if (signature(header(0)) != internal::Header_Signature::Library) {
+					return NStatus::No_Library_Header;
+				}
+				if (signature(header(3)) != internal::Header_Signature::Member) {
+					return NStatus::No_Member_Header;
+				}
+				if (signature(header(4)) != internal::Header_Signature::Descriptor) {
+					return NStatus::No_Descriptor_Header;
+				}
+
+				const auto namestr_header = header(7);
+				if (signature(namestr_header) != internal::Header_Signature::Namestr) {
+					return NStatus::No_Namestr_Header;
+				}
+
+				const size_t cnt = internal::Parse_Variable_Count(namestr_header, version);
+				const size_t namestr_size = internal::Parse_Namestr_Size(header(3));
+				size_t observation_offset = Namestr_Offset + (cnt * namestr_size + 79) / 80 * 80;
+
+				required = observation_offset + 80;
+				if (buffer.size() < required) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				// labels longer than 40 characters of V8 files follow in the label records, whose size is known only when parsed
+				size_t label_offset = 0;
+				size_t label_count = 0;
+				size_t label_bytes = 0;
+				bool label_v9 = false;
+				const auto label_signature = signature(header(observation_offset / 80));
+				if (label_signature == internal::Header_Signature::Label || label_signature == internal::Header_Signature::Label_V9) {
+					label_v9 = label_signature == internal::Header_Signature::Label_V9;
+					label_count = internal::Parse_Label_Count(header(observation_offset / 80));
+					label_offset = observation_offset + 80;
+
+					size_t offset = label_offset;
+					for (size_t i = 0; i < label_count; i++) {
+						internal::Label_Entry entry;
+						size_t size = 0;
+						if (!internal::Parse_Label_Entry(buffer, offset, label_v9, entry, size)) {
+							required = offset + size + 80;
+							return NStatus::Unexpected_EOF;
+						}
+						offset += size;
+						label_bytes += entry.name.size() + entry.label.size();
+					}
+
+					observation_offset = label_offset + (offset - label_offset + 79) / 80 * 80;
+					required = observation_offset + 80;
+					if (buffer.size() < required) {
+						return NStatus::Unexpected_EOF;
+					}
+				}
+
+				if (signature(header(observation_offset / 80)) != internal::Header_Signature::Observation) {
+					return NStatus::No_Observation_Header;
+				}
+
+				// the arena is sized for the longest possible names and labels, so the views are never invalidated by reallocation
+				const auto member_header_2 = internal::Get_From_Buffer<internal::Member_Header_Record_2>(buffer, 6 * 80);
+
+				constexpr size_t Name_Label_Size = sizeof(internal::Namestr_Record_2::longname) + sizeof(internal::Namestr_Record_1::nlabel);
+				mArena.resize((cnt + 1) * Name_Label_Size + label_bytes);
+				size_t arena_used = 0;
+
+				if (version == NFormat_Version::V8) {
+					const auto member_header_1 = internal::Get_From_Buffer<internal::Member_Header_Record_V8>(buffer, 5 * 80);
+					mDataset_Name = Store(member_header_1.sas_dsname, sizeof(member_header_1.sas_dsname), arena_used);
+				}
+				else {
+					const auto member_header_1 = internal::Get_From_Buffer<internal::Member_Header_Record>(buffer, 5 * 80);
+					mDataset_Name = Store(member_header_1.sas_dsname, sizeof(member_header_1.sas_dsname), arena_used);
+				}
+				mDataset_Label = Store(member_header_2.dslabel, sizeof(member_header_2.dslabel), arena_used);
+
+				mVariables.resize(cnt);
+				mRecord_Len = 0;
+				for (size_t i = 0; i < cnt; i++) {
+					const size_t offset = Namestr_Offset + i * namestr_size;
+					const auto namestr1 = internal::Get_From_Buffer<internal::Namestr_Record_1>(buffer, offset);
+					const auto namestr2 = internal::Get_From_Buffer<internal::Namestr_Record_2>(buffer, offset + sizeof(internal::Namestr_Record_1));
+
+					auto& var = mVariables[i];
+					const auto name = internal::Namestr_Name(namestr1, namestr2, version);
+					var.name = Store(name.data(), name.size(), arena_used);
+					var.label = Store(namestr1.nlabel, sizeof(namestr1.nlabel), arena_used);
+					var.type = static_cast<NVar_Type>(internal::To_Machine_Endian_Raw(namestr1.ntype));
+					var.length = internal::To_Machine_Endian_Raw(namestr1.nlng);
+					var.number = internal::To_Machine_Endian_Raw(namestr1.nvar0);
+					var.position = static_cast<uint32_t>(internal::To_Machine_Endian_Raw(namestr2.npos));
+
+					mRecord_Len += var.length;
+				}
+
+				// the long labels (and names) replace the ones of the descriptors
+				for (size_t i = 0, offset = label_offset; i < label_count; i++) {
+					internal::Label_Entry entry;
+					size_t size = 0;
+					internal::Parse_Label_Entry(buffer, offset, label_v9, entry, size);
+					offset += size;
+
+					auto itr = std::find_if(mVariables.begin(), mVariables.end(), [&entry](const Variable& var) {
+						return var.number == entry.number;
+					});
+					if (itr == mVariables.end()) {
+						continue;
+					}
+					if (!entry.name.empty()) {
+						itr->name = Store(entry.name.data(), entry.name.size(), arena_used);
+					}
+					itr->label = Store(entry.label.data(), entry.label.size(), arena_used);
+				}
+
+				mData_Offset = required;
+				return NStatus::Ok;
+			}
+
+			friend class File;
+
+		public:
+			Metadata() = default;
+			Metadata(const Metadata&) = delete;
+			Metadata& operator=(const Metadata&) = delete;
+			Metadata(Metadata&&) = default;
+			Metadata& operator=(Metadata&&) = default;
+
+			std::string_view Dataset_Name() const {
+				return mDataset_Name;
+			}
+
+			std::string_view Dataset_Label() const {
+				return mDataset_Label;
+			}
+
+			std::span<const Variable> Variables() const {
+				return mVariables;
+			}
+
+			// length of a single row in bytes
+			size_t Record_Length() const {
+				return mRecord_Len;
+			}
+
+			// offset of the first row in the file
+			size_t Data_Offset() const {
+				return mData_Offset;
+			}
+	};
+
+	// comparison operators of row filter conditions
+	enum class NCompare {
+		Equal,
+		Not_Equal,
+		Less,
+		Less_Equal,
+		Greater,
+		Greater_Equal,
+		Starts_With,	// string variables only
+	};
+
+	/**
+	 * Condition of the row filter (see File::Set_Filter), e.g. { "PARAMCD", xpt::NCompare::Equal, "ALT" } or { "AVAL", xpt::NCompare::Greater, 3.0 }
+	 * The value of the variable is compared to the given value, which must be of the same type as the variable
+	 */
+	struct Condition {
+		std::string variable;
+		NCompare op;
+		TValue value;
+	};
+
+	/**
+	 * Statistics of the reads of xpt::File (see File::Get_Stats); collected only if XPTLIB_ENABLE_STATS is defined, all zero otherwise
+	 * The I/O counters cover the reads of the observations; the time spent in the caller is the wall time minus the sum of the phases
+	 * The value counters count the values actually decoded, which differ for filtered batches (see File::Set_Filter): numeric columns
+	 * are converted in bulk for all the rows read, while just the strings of the rows meeting the filter are decoded
+	 */
+	struct File_Stats {
+		uint64_t bytes_read = 0;			// bytes of observations read from the source
+		uint64_t read_calls = 0;			// count of reads from the source
+		uint64_t rows_decoded = 0;			// count of rows decoded (by both row and batch reads)
+		uint64_t numeric_values = 0;		// count of numeric values decoded (of all the rows read, even in filtered batches)
+		uint64_t string_values = 0;			// count of string values decoded (of the rows meeting the filter; lazy strings are not counted)
+		uint64_t io_ns = 0;					// time spent reading from the source
+		uint64_t numeric_ns = 0;			// time spent converting numeric columns of batches
+		uint64_t string_ns = 0;				// time spent trimming and copying string columns of batches
+		uint64_t row_decode_ns = 0;			// time spent decoding rows by the row reads (Read_Next)
+
+		File_Stats& operator+=(const File_Stats& other) {
+			bytes_read += other.bytes_read;
+			read_calls += other.read_calls;
+			rows_decoded += other.rows_decoded;
+			numeric_values += other.numeric_values;
+			string_values += other.string_values;
+			io_ns += other.io_ns;
+			numeric_ns += other.numeric_ns;
+			string_ns += other.string_ns;
+			row_decode_ns += other.row_decode_ns;
+			return *this;
+		}
+	};
+
+	/**
+	 * Specification of a numeric variable aggregated by File::Aggregate; if histogram_bins is non-zero, a histogram of that many bins
+	 * of equal width between histogram_min and histogram_max is computed as well (the range must be finite, and histogram_max greater)
+	 */
+	struct Aggregate_Spec {
+		std::string variable;
+		size_t histogram_bins = 0;
+		double histogram_min = 0.0;
+		double histogram_max = 0.0;
+	};
+
+	/**
+	 * Summary statistics of a numeric column, computed by File::Aggregate; missing values are counted, but do not contribute to other statistics
+	 * Partial statistics of disjoint sets of rows (with the same histogram bins) may be combined using Merge
+	 */
+	struct Column_Stats {
+		size_t variable = 0;										// index of the variable in File::Get_Variable_Vector
+		size_t count = 0;											// count of non-missing values
+		size_t missing_count = 0;									// count of missing values
+		double min = std::numeric_limits<double>::infinity();		// minimum (infinity if there are no values)
+		double max = -std::numeric_limits<double>::infinity();		// maximum (-infinity if there are no values)
+		double sum = 0.0;
+		double mean = 0.0;
+		double m2 = 0.0;											// sum of squared deviations from the mean
+
+		// histogram; the last bin includes histogram_max, values outside the range are counted in underflow and overflow
+		double histogram_min = 0.0;
+		double histogram_max = 0.0;
+		std::vector<uint64_t> histogram;
+		uint64_t underflow = 0;
+		uint64_t overflow = 0;
+
+		// retrieves the sample variance (NaN if there are less than two values)
+		double Variance() const {
+			return count > 1 ? m2 / static_cast<double>(count - 1) : std::numeric_limits<double>::quiet_NaN();
+		}
+
+		// retrieves the sample standard deviation (NaN if there are less than two values)
+		double Std_Dev() const {
+			return std::sqrt(Variance());
+		}
+
+		// adds n values to the statistics
+		void Add(const double* values, size_t n) {
+			internal::Value_Summary summary;
+			internal::Summarize(values, n, summary);
+
+			missing_count += n - summary.count;
+			Merge_Moments(summary.count, summary.sum, summary.min, summary.max, summary.m2);
+
+			// the values are not binned for an invalid range (see Aggregate_Spec), so the bin index is always defined
+			if (!histogram.empty() && histogram_max > histogram_min && std::isfinite(histogram_max - histogram_min)) {
+				const double scale = static_cast<double>(histogram.size()) / (histogram_max - histogram_min);
+				const double last_bin = static_cast<double>(histogram.size() - 1);
+				for (size_t i = 0; i < n; i++) {
+					const double v = values[i];
+					if (v < histogram_min) {
+						underflow++;
+					}
+					else if (v > histogram_max) {
+						overflow++;
+					}
+					else if (v == v) {
+						histogram[static_cast<size_t>(std::min((v - histogram_min) * scale, last_bin))]++;
+					}
+				}
+			}
+		}
+
+		// combines the statistics with the statistics of other rows of the same variable (and with the same histogram bins)
+		void Merge(const Column_Stats& other) {
+			missing_count += other.missing_count;
+			Merge_Moments(other.count, other.sum, other.min, other.max, other.m2);
+
+			for (size_t i = 0; i < std::min(histogram.size(), other.histogram.size()); i++) {
+				histogram[i] += other.histogram[i];
+			}
+			underflow += other.underflow;
+			overflow += other.overflow;
+		}
+
+		private:
+			// combines the moments of two sets of values, using the parallel variant of Welford's algorithm (Chan et al.)
+			void Merge_Moments(size_t other_count, double other_sum, double other_min, double other_max, double other_m2) {
+				if (other_count == 0) {
+					return;
+				}
+
+				const double other_mean = other_sum / static_cast<double>(other_count);
+				const size_t total = count + other_count;
+				const double delta = other_mean - mean;
+
+				mean += delta * static_cast<double>(other_count) / static_cast<double>(total);
+				m2 += other_m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other_count) / static_cast<double>(total);
+				count = total;
+				sum += other_sum;
+				min = std::min(min, other_min);
+				max = std::max(max, other_max);
+			}
+	};
+
+	namespace internal {
+
+		using Stats_Clock = std::chrono::steady_clock;
+
+		// retrieves the nanoseconds elapsed since the given time point (see XPTLIB_STATS)
+		inline uint64_t Elapsed_Ns(Stats_Clock::time_point start) {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Stats_Clock::now() - start).count());
+		}
+
+		// serializer of the sidecar index (see File::Write_Index); values are stored in machine representation, as the index is a local cache
+		struct Index_Writer {
+			std::vector<std::byte> data;
+
+			template<typename T> requires std::is_trivially_copyable_v<T>
+			void Put(const T& value) {
+				const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+				data.insert(data.end(), bytes, bytes + sizeof(T));
+			}
+
+			void Put_String(std::string_view str) {
+				Put<uint64_t>(str.size());
+				const auto* bytes = reinterpret_cast<const std::byte*>(str.data());
+				data.insert(data.end(), bytes, bytes + str.size());
+			}
+		};
+
+		// deserializer of the sidecar index; any read beyond the data marks the reader as failed, and yields empty values
+		struct Index_Reader {
+			std::span<const std::byte> data;
+			size_t pos = 0;
+			bool failed = false;
+
+			template<typename T> requires std::is_trivially_copyable_v<T>
+			T Get() {
+				T value{};
+				if (failed || data.size() - pos < sizeof(T)) {
+					failed = true;
+					return value;
+				}
+				std::memcpy(&value, data.data() + pos, sizeof(T));
+				pos += sizeof(T);
+				return value;
+			}
+
+			std::string Get_String() {
+				const auto size = Get<uint64_t>();
+				if (failed || data.size() - pos < size) {
+					failed = true;
+					return {};
+				}
+				std::string str{ reinterpret_cast<const char*>(data.data() + pos), static_cast<size_t>(size) };
+				pos += static_cast<size_t>(size);
+				return str;
+			}
+
+			// reads a count of items of at least a given size each, failing if the data cannot contain that many
+			size_t Get_Count(size_t item_size) {
+				const auto count = Get<uint64_t>();
+				if (failed || count > (data.size() - pos) / item_size) {
+					failed = true;
+					return 0;
+				}
+				return static_cast<size_t>(count);
+			}
+		};
+
+		// identification and version of the sidecar index file
+		constexpr std::array<char, 8> Index_Magic = { 'X', 'P', 'T', 'L', 'I', 'B', 'I', 'X' };
+		constexpr uint32_t Index_Version = 4;
+		constexpr uint32_t Index_Byte_Order = 0x01020304;
+
+		// zone map entry - range of values of a numeric variable in a block of rows (see File::Write_Index)
+		struct Block_Zone {
+			double min = std::numeric_limits<double>::infinity();		// minimum of non-missing values (infinity if there are none)
+			double max = -std::numeric_limits<double>::infinity();		// maximum of non-missing values (-infinity if there are none)
+			uint8_t has_missing = 0;									// does the block contain missing values?
+
+			// size of the serialized entry (the fields are stored one by one, without the padding)
+			static constexpr size_t Serialized_Size = sizeof(double) * 2 + sizeof(uint8_t);
+		};
+
+		/**
+		 * Condition of the row filter resolved against the variables of the file; evaluated directly on the raw row
+		 */
+		struct Row_Condition {
+			size_t position = 0;			// offset of the value in the row
+			size_t length = 0;				// length of the value in the row
+			NDecode_Kind decode = NDecode_Kind::Number;
+			NCompare op = NCompare::Equal;
+			double number = 0.0;			// compared value of numeric variables
+			std::string text;				// compared value of string variables
+			bool raw_compare = false;		// can the string be compared to the padded field directly? (see Matches_String)
+			size_t variable = 0;			// index of the variable
+
+			// can any row of the block with given zone map meet the condition? (numeric variables only)
+			bool May_Match(const Block_Zone& zone) const {
+				switch (op) {
+					case NCompare::Equal:			return zone.min <= number && number <= zone.max;
+					case NCompare::Not_Equal:		return zone.has_missing || !(zone.min == number && zone.max == number);
+					case NCompare::Less:			return zone.min < number;
+					case NCompare::Less_Equal:		return zone.min <= number;
+					case NCompare::Greater:			return zone.max > number;
+					case NCompare::Greater_Equal:	return zone.max >= number;
+					default:						return true;
+				}
+			}
+
+			template<typename T>
+			bool Compare(const T& value, const T& reference) const {
+				switch (op) {
+					case NCompare::Equal:			return value == reference;
+					case NCompare::Not_Equal:		return value != reference;
+					case NCompare::Less:			return value < reference;
+					case NCompare::Less_Equal:		return value <= reference;
+					case NCompare::Greater:			return value > reference;
+					case NCompare::Greater_Equal:	return value >= reference;
+					default:						return false;
+				}
+			}
+
+			bool Matches_String(const char* field) const {
+
+				// the value read would be trimmed; if the field starts with a blank, or the compared value ends with one, the padded field
+				// cannot be compared directly, so it is trimmed first (this is rare)
+				if ((op == NCompare::Equal || op == NCompare::Not_Equal || op == NCompare::Starts_With) && raw_compare && !Is_Blank(field[0])) {
+					const bool prefix = std::memcmp(field, text.data(), text.size()) == 0;
+					if (op == NCompare::Starts_With) {
+						return prefix;
+					}
+
+					// the rest of the field must be just the padding
+					const bool equal = prefix && Trimmed_Length(field + text.size(), length - text.size()) == 0;
+					return (op == NCompare::Equal) == equal;
+				}
+
+				const auto view = Trim_View(field, length);
+				if (op == NCompare::Starts_With) {
+					return view.starts_with(text);
+				}
+				return Compare(view, std::string_view{ text });
+			}
+
+			bool Matches(std::span<const std::byte> row) const {
+				switch (decode) {
+					case NDecode_Kind::Number:
+						return Compare(IbmToIEEE(Get_From_Buffer<uint64_t>(row, position)), number);
+					case NDecode_Kind::Short_Number:
+						return Compare(IbmToIEEE(Get_Number_From_Buffer(row, position, length)), number);
+					default:
+						return Matches_String(reinterpret_cast<const char*>(row.data() + position));
+				}
+			}
+		};
+
+		/**
+		 * Owner of the structures and buffers of an exported Arrow schema or array; each of the exported structures (the root, its children
+		 * and dictionaries) holds a shared reference, so they can be released independently, as required by the C data interface
+		 */
+		template<typename TArrow>
+		struct Arrow_Holder {
+			Column_Batch batch;									// exported batch (arrays only)
+			std::vector<std::string> names;						// names of the fields (schemas only)
+			std::vector<TArrow> children;
+			std::vector<TArrow*> child_pointers;
+			std::vector<TArrow> dictionaries;					// by child, used only by dictionary-encoded children
+			std::vector<std::array<const void*, 3>> buffers;	// by child (arrays only)
+			std::vector<std::array<const void*, 3>> dictionary_buffers;
+			std::array<const void*, 1> root_buffers{ nullptr };	// validity of the struct array (arrays only)
+		};
+
+		template<typename TArrow>
+		void Release_Arrow(TArrow* arrow) {
+			auto* holder = static_cast<std::shared_ptr<Arrow_Holder<TArrow>>*>(arrow->private_data);
+
+			// the root releases the children not moved away by the consumer
+			for (int64_t i = 0; i < arrow->n_children; i++) {
+				if (arrow->children[i]->release) {
+					arrow->children[i]->release(arrow->children[i]);
+				}
+			}
+			if (arrow->dictionary && arrow->dictionary->release) {
+				arrow->dictionary->release(arrow->dictionary);
+			}
+
+			delete holder;
+			arrow->release = nullptr;
+		}
+
+		// fills the exported structure, which keeps a reference to the holder
+		template<typename TArrow>
+		void Share_Arrow(TArrow& arrow, const std::shared_ptr<Arrow_Holder<TArrow>>& holder) {
+			arrow.private_data = new std::shared_ptr<Arrow_Holder<TArrow>>(holder);
+			arrow.release = Release_Arrow<TArrow>;
+		}
+
+		// fills the schema of a field
+		inline void Fill_Arrow_Schema(ArrowSchema& schema, const char* format, const char* name, int64_t flags) {
+			schema = ArrowSchema{};
+			schema.format = format;
+			schema.name = name;
+			schema.flags = flags;
+		}
+	}
+
+	/**
+	 * A class representing XPT file loader
+	 */
+	class File {
+
+		private:
+			// source of the XPT file contents
+			std::unique_ptr<Input_Source> mSource;
+
+			// path of the file, if it was opened from one (the sidecar index is bound to it, see Write_Index)
+			std::filesystem::path mPath;
+
+		public:
+			// entry of the member (dataset) index of a library file (see Read_Member_Index)
+			struct Member_Info {
+				std::string name;							// dataset name
+				std::string label;							// dataset label
+				std::vector<Variable_Record> variables;		// variables of the dataset
+				size_t record_length = 0;					// length of a single row
+				size_t data_offset = 0;						// offset of the first row in the file
+				size_t row_count = 0;						// count of rows
+				NFormat_Version version = NFormat_Version::V5;
+				size_t stated_row_count = 0;				// count of rows stated by the observation header (V8 files only), zero if not stated
+
+				// raw member header records, decoded on demand by File accessors (the V8 header is converted to the V5 layout)
+				internal::Member_Header_Record header{};
+				internal::Member_Header_Record_2 header_2{};
+
+				// zone maps of numeric variables (by variable, empty for string variables), one zone per block of zone_rows rows;
+				// available only if the index was built by Write_Index or loaded by Read_Index
+				size_t zone_rows = 0;
+				std::vector<std::vector<internal::Block_Zone>> zones;
+			};
+
+		private:
+			// index of members, if built by Read_Member_Index
+			std::vector<Member_Info> mMembers;
+
+			// raw library and member header records, decoded on demand by the accessors
+			internal::File_Header_Record mFile_Header{};
+			internal::Date_Time_Record mLibrary_Modified{};
+			internal::Member_Header_Record mMember_Header{};
+
+			// name of the dataset being read (it is truncated in the V5 layout of the member header)
+			std::string mDataset_Name;
+
+			// version of the transport format, determined by the library header
+			NFormat_Version mFormat_Version = NFormat_Version::V5;
+			internal::Member_Header_Record_2 mMember_Header_2{};
+
+			// stored variables
+			std::vector<Variable_Record> mVariables;
+
+			// indices of variables (columns) retrieved by the read methods, in the order they are retrieved
+			std::vector<size_t> mSelection;
+
+			// actual record ("row") length (so we can properly read the records) - this is a sum of all variable lengths
+			size_t mRecord_Len = 0;
+
+			// buffer of the last read row; reused across reads, so the steady-state reading does not allocate
+			std::vector<std::byte> mRow_Buffer;
+
+			// buffer of the last read block of rows (see Read_Batch)
+			std::vector<std::byte> mBatch_Buffer;
+
+			// are string columns of batches left in the data read from the file, and trimmed only on access? (see Set_Lazy_Strings)
+			bool mLazy_Strings = false;
+
+			// flags of string variables, which are dictionary-encoded by the batch reads (see Set_Dictionary_Encoding); by variable index
+			std::vector<bool> mDictionary_Encoded;
+
+			// conditions of the row filter, all of them must be met (see Set_Filter); empty if the rows are not filtered
+			std::vector<internal::Row_Condition> mFilter;
+
+			// statistics of the reads, collected only if XPTLIB_ENABLE_STATS is defined (updated also by the const batch methods)
+			mutable File_Stats mStats;
+
+			// zone maps of the member being read (see Member_Info::zones); empty if not available
+			size_t mZone_Rows = 0;
+			std::vector<std::vector<internal::Block_Zone>> mZones;
+
+			// offset of the first observation in the file
+			size_t mData_Offset = 0;
+
+			// count of observations, if it can be determined (i.e., the size of the source is known); while mRow_Count_Pending is set,
+			// it is just the count of rows fitting to the file, as the rows may end earlier at the header of the next member of a library,
+			// which is looked for by the sequential reads, or searched for once the count is needed (see Resolve_Row_Count)
+			mutable std::optional<size_t> mRow_Count;
+			mutable bool mRow_Count_Pending = false;
+
+			// index of the row to be read next
+			size_t mNext_Row = 0;
+
+		private:
+			// read a given structure from file; if padding is enabled, the read is extended to 80 bytes, but only a lower part corresponding to given type is stored
+			// returns false if an EOF occurred
+			template<typename T, bool padded = true>
+			bool Read(T& target) {
+				const size_t bytes_to_read = (padded ? 80 : sizeof(T));
+
+				// always add padding, even if no padding is requested to simplify things
+				struct {
+					union {
+						T data;
+						char padding[80];
+					};
+				} data_padded;
+
+				// read and check size read
+				if (!mSource || mSource->Read(reinterpret_cast<std::byte*>(&data_padded.data), bytes_to_read) != bytes_to_read)
+					return false;
+
+				target = data_padded.data;
+				return true;
+			}
+
+			// reads a given count of bytes into target vector; returns false if an EOF occurred
+			bool Read(std::vector<std::byte>& target, size_t byte_count) {
+				target.resize(byte_count);
+				return mSource && mSource->Read(target.data(), byte_count) == byte_count;
+			}
+
+			// reads a single row; the result points either to the row buffer, or directly to the source memory
+			// returns false if an EOF occurred (there are no more rows)
+			bool Fetch_Row(std::span<const std::byte>& row) {
+				if (!mSource || (mRow_Count.has_value() && mNext_Row >= *mRow_Count)) {
+					return false;
+				}
+
+				XPTLIB_STATS(const auto io_start = internal::Stats_Clock::now());
+				row = mSource->Fetch(mRecord_Len, mRow_Buffer);
+				XPTLIB_STATS(mStats.io_ns += internal::Elapsed_Ns(io_start); mStats.read_calls++; mStats.bytes_read += row.size());
+
+				if (row.size() != mRecord_Len) {
+					return false;
+				}
+
+				if (mRow_Count_Pending) {
+					Check_Member_End(row, mData_Offset + mNext_Row * mRecord_Len);
+					if (mRow_Count.has_value() && mNext_Row >= *mRow_Count) {
+						return false;
+					}
+				}
+
+				mNext_Row++;
+				return true;
+			}
+
+#if defined(XPTLIB_ENABLE_STATS)
+			// counts the row decoded by Read_Next to vector, along with its (selected) values
+			void Count_Row_Decode(internal::Stats_Clock::time_point decode_start) {
+				mStats.row_decode_ns += internal::Elapsed_Ns(decode_start);
+				mStats.rows_decoded++;
+				for (const auto idx : mSelection) {
+					(mVariables[idx].type == NVar_Type::Numeric ? mStats.numeric_values : mStats.string_values)++;
+				}
+			}
+#endif
+
+			// decodes the selected values of the row to cells; strings are copied to the arena
+			void Decode_Cells(std::span<const std::byte> row, Cell* target, String_Arena& arena) const {
+				for (size_t i = 0; i < mSelection.size(); i++) {
+
+					const auto& mvar = mVariables[mSelection[i]];
+
+					if (mvar.type == NVar_Type::Numeric) {
+						target[i] = Cell{ internal::IbmToIEEE(Fetch_Number(row, mvar)) };
+					}
+					else {
+						target[i] = Cell{ arena.Store(internal::Get_View_From_Buffer(row, mvar.position, mvar.length)) };
+					}
+				}
+			}
+
+			// does the raw row meet all the conditions of the filter?
+			bool Matches_Filter(std::span<const std::byte> row) const {
+				for (const auto& cond : mFilter) {
+					if (!cond.Matches(row)) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			// reads the next row meeting the filter; the rows not meeting it are skipped without being decoded
+			bool Fetch_Matching_Row(std::span<const std::byte>& row) {
+				for (;;) {
+					if (mZone_Rows != 0 && !mFilter.empty() && mNext_Row % mZone_Rows == 0) {
+						Skip_Blocks();
+					}
+					if (!Fetch_Row(row)) {
+						return false;
+					}
+					if (Matches_Filter(row)) {
+						return true;
+					}
+				}
+			}
+
+			// determines the key binding the sidecar index to the file contents - its size and time of the last modification
+			bool Index_Key(uint64_t& size, int64_t& modified) const {
+				std::error_code ec;
+				size = static_cast<uint64_t>(std::filesystem::file_size(mPath, ec));
+				if (ec) {
+					return false;
+				}
+
+				const auto time = std::filesystem::last_write_time(mPath, ec);
+				modified = static_cast<int64_t>(time.time_since_epoch().count());
+				return !ec;
+			}
+
+			// computes the hash of the first size bytes of the file (the headers); the source position is not restored
+			std::optional<uint64_t> Hash_Headers(size_t size) {
+				std::vector<std::byte> headers;
+				if (!mSource || !mSource->Seek(0) || !Read(headers, size)) {
+					return std::nullopt;
+				}
+				return internal::Hash_Bytes(std::string_view{ reinterpret_cast<const char*>(headers.data()), headers.size() });
+			}
+
+			// is the member loaded from the sidecar index consistent with itself and with the size of the file? (see Read_Index)
+			static bool Is_Consistent(const Member_Info& member, uint64_t file_size) {
+				for (const auto& var : member.variables) {
+					const bool valid_type = (var.type == NVar_Type::Numeric)
+						? (var.length >= 2 && var.length <= 8 && var.decode == (var.length == 8 ? internal::NDecode_Kind::Number : internal::NDecode_Kind::Short_Number))
+						: (var.type == NVar_Type::String && var.length >= 1 && var.decode == internal::NDecode_Kind::String);
+
+					if (!valid_type || var.position > member.record_length || var.length > member.record_length - var.position) {
+						return false;
+					}
+				}
+
+				// the rows must lie within the file
+				if (member.data_offset > file_size) {
+					return false;
+				}
+				if (member.record_length == 0 ? member.row_count != 0 : member.row_count > (file_size - member.data_offset) / member.record_length) {
+					return false;
+				}
+
+				// each numeric variable has a zone per block of rows, string variables have none
+				if (member.zone_rows != 0) {
+					const size_t blocks = member.row_count / member.zone_rows + (member.row_count % member.zone_rows != 0 ? 1 : 0);
+					for (size_t v = 0; v < member.variables.size(); v++) {
+						const bool numeric = member.variables[v].type == NVar_Type::Numeric;
+						if (member.zones[v].size() != (numeric ? blocks : 0)) {
+							return false;
+						}
+					}
+				}
+
+				return true;
+			}
+
+			// can any row of the block of a given index meet the filter, according to the zone maps?
+			bool Block_May_Match(size_t block) const {
+				for (const auto& cond : mFilter) {
+					const auto& zones = mZones[cond.variable];
+					if (block < zones.size() && !cond.May_Match(zones[block])) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			// skips the blocks of rows starting at the current row, in which no row can meet the filter
+			void Skip_Blocks() {
+				size_t row = mNext_Row;
+				while (row % mZone_Rows == 0 && row < mRow_Count.value_or(0) && !Block_May_Match(row / mZone_Rows)) {
+					row += mZone_Rows;
+				}
+
+				// if the source cannot seek, the rows are just read and filtered as usual
+				if (row != mNext_Row) {
+					Seek_Row(std::min(row, *mRow_Count));
+				}
+			}
+
+			// discards a given count of bytes from input stream
+			void Read_Discard(size_t count) {
+				mSource->Skip(count);
+			}
+
+			// determines the count of observations of the observation section lying between given offsets; the source position is not restored
+			std::optional<size_t> Count_Rows(size_t data_offset, size_t data_end, size_t record_len) const {
+
+				if (data_end == 0 || data_end < data_offset || record_len == 0) {
+					return std::nullopt;
+				}
+
+				const size_t data_len = data_end - data_offset;
+				size_t count = data_len / record_len;
+
+				// the observation section is padded with blanks to the 80-byte boundary, so up to 79 trailing bytes may be the padding;
+				// a blank row may not be distinguished from the padding, so blank rows lying entirely in this area are not considered rows
+				const size_t padding_start = data_len > 79 ? data_len - 79 : 0;
+				const size_t first_candidate = (padding_start + record_len - 1) / record_len;
+
+				if (first_candidate < count) {
+					std::vector<std::byte> tail((count - first_candidate) * record_len);
+
+					if (!mSource->Seek(data_offset + first_candidate * record_len) || mSource->Read(tail.data(), tail.size()) != tail.size()) {
+						return std::nullopt;
+					}
+
+					while (count > first_candidate) {
+						const auto row_begin = tail.begin() + (count - 1 - first_candidate) * record_len;
+						if (!std::all_of(row_begin, row_begin + record_len, [](std::byte b) { return b == std::byte{ ' ' }; })) {
+							break;
+						}
+						count--;
+					}
+				}
+
+				return count;
+			}
+
+			// finds the end of the observation section starting at a given offset - the offset of the next member header, or the end of file
+			// the rows are not decoded, only the 80-byte records are compared with the member header; the source is left at an unspecified position
+			size_t Find_Member_End(size_t data_offset, bool& next_member) const {
+
+				const std::string_view Member_Prefix = Member_Header_Prefix();
+
+				std::vector<std::byte> scratch;
+				size_t offset = data_offset;
+
+				next_member = false;
+				if (!mSource->Seek(data_offset)) {
+					return data_offset;
+				}
+
+				constexpr size_t Block_Size = 80 * 4096;
+				while (true) {
+					const auto block = mSource->Fetch(Block_Size, scratch);
+
+					for (size_t pos = 0; pos + Member_Prefix.size() <= block.size(); pos += 80) {
+						if (std::memcmp(block.data() + pos, Member_Prefix.data(), Member_Prefix.size()) == 0) {
+							next_member = true;
+							return offset + pos;
+						}
+					}
+
+					offset += block.size();
+					if (block.size() < Block_Size) {
+						return offset;
+					}
+				}
+			}
+
+			// determines the count of rows, if the rows may end at the header of the next member (see mRow_Count_Pending), searching for it
+			// from a given offset - no rows before it may contain the header. The source position is restored
+			void Resolve_Row_Count(size_t search_offset) const {
+				if (!mRow_Count_Pending) {
+					return;
+				}
+				mRow_Count_Pending = false;
+
+				// without the next member, the rows extend to the end of file, as already counted
+				const size_t position = mSource->Tell();
+				bool next_member = false;
+				const size_t data_end = Find_Member_End(search_offset, next_member);
+				if (next_member) {
+					mRow_Count = Count_Rows(mData_Offset, data_end, mRecord_Len);
+				}
+				if (!mSource->Seek(position)) {
+					mRow_Count.reset();
+				}
+			}
+
+			// determines the count of rows (see above); the rows read so far were checked by Check_Member_End, so the search starts
+			// at the record containing the start of the next row
+			void Resolve_Row_Count() const {
+				Resolve_Row_Count(mData_Offset + mNext_Row * mRecord_Len / 80 * 80);
+			}
+
+			// checks the data of rows read sequentially from a given offset for the header of the next member, while the rows may end
+			// at it (see mRow_Count_Pending); just the 80-byte records starting in the data are compared, the count of rows is determined
+			// once any of them (or its part at the end of the data) matches
+			void Check_Member_End(std::span<const std::byte> data, size_t offset) const {
+				const std::string_view prefix = Member_Header_Prefix();
+
+				for (size_t pos = (80 - offset % 80) % 80; pos < data.size(); pos += 80) {
+					const size_t count = std::min(prefix.size(), data.size() - pos);
+					if (std::memcmp(data.data() + pos, prefix.data(), count) == 0) {
+						Resolve_Row_Count(offset + pos);
+						return;
+					}
+				}
+
+				// blank rows right before the next member may be the padding of the observation section, so the record following
+				// the data is checked as well
+				const auto last_row = data.last(std::min(data.size(), mRecord_Len));
+				if (last_row.empty() || !std::all_of(last_row.begin(), last_row.end(), [](std::byte b) { return b == std::byte{ ' ' }; })) {
+					return;
+				}
+
+				const size_t next_record = (offset + data.size() + 79) / 80 * 80;
+				const size_t position = mSource->Tell();
+				bool next_member = false;
+				Is_Member_End(next_record, next_member);
+				if (!mSource->Seek(position)) {
+					mRow_Count.reset();
+					mRow_Count_Pending = false;
+				}
+				else if (next_member) {
+					Resolve_Row_Count(next_record);
+				}
+			}
+
+			// retrieves the start of the member header record of the format being read, which marks the start of the next member
+			std::string_view Member_Header_Prefix() const {
+				if (mFormat_Version == NFormat_Version::V8) {
+					return "HEADER RECORD*******MEMBV8  HEADER RECORD!!!!!!!";
+				}
+				return "HEADER RECORD*******MEMBER  HEADER RECORD!!!!!!!";
+			}
+
+			// checks whether the observation section of the member ends at a given offset (the count of rows was stated by its header),
+			// i.e., there is either the header of the next member, or the end of file; the source is left at an unspecified position
+			bool Is_Member_End(size_t offset, bool& next_member) const {
+				std::array<std::byte, 80> record;
+				if (!mSource->Seek(offset)) {
+					return false;
+				}
+
+				const size_t read = mSource->Read(record.data(), record.size());
+				const auto prefix = Member_Header_Prefix();
+				next_member = read == record.size() && std::memcmp(record.data(), prefix.data(), prefix.size()) == 0;
+				return read == 0 || next_member;
+			}
+
+			// reads the library header (the first three records of the file); the version of the format is determined by its signature
+			NStatus Read_Library_Header() {
+
+				internal::Data_Header_Generic hdr;
+
+				if (!Read(hdr)) {
+					return NStatus::Unexpected_EOF;
+				}
+				if (internal::Recognize_Signature(std::string_view{ hdr.namedesc, sizeof(hdr.namedesc) }, &mFormat_Version) != internal::Header_Signature::Library) {
+					return NStatus::No_Library_Header;
+				}
+
+				// the header and the date of modification in the second record are kept as they are, and decoded only when asked for
+				if (!Read(mFile_Header) || !Read(mLibrary_Modified)) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				return NStatus::Ok;
+			}
+
+			// reads the headers of a single member (dataset), from its member header up to the observation header
+			NStatus Read_Member_Headers(Member_Info& member) {
+
+				internal::Data_Header_Generic hdr;
+				member.version = mFormat_Version;
+
+				if (!Read(hdr)) {
+					return NStatus::Unexpected_EOF;
+				}
+				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Member) {
+					return NStatus::No_Member_Header;
+				}
+
+				const size_t namestr_size = internal::Parse_Namestr_Size(hdr);
+
+				if (!Read(hdr)) {
+					return NStatus::Unexpected_EOF;
+				}
+				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Descriptor) {
+					return NStatus::No_Descriptor_Header;
+				}
+
+				internal::Member_Header_Record member_header_1;
+				internal::Member_Header_Record_2 member_header_2;
+				if (mFormat_Version == NFormat_Version::V8) {
+					internal::Member_Header_Record_V8 member_header_v8;
+					if (!Read(member_header_v8)) {
+						return NStatus::Unexpected_EOF;
+					}
+					member.name = internal::Char_To_String(member_header_v8.sas_dsname);
+					member_header_1 = internal::To_Member_Header(member_header_v8);
+				}
+				else {
+					if (!Read(member_header_1)) {
+						return NStatus::Unexpected_EOF;
+					}
+					member.name = internal::Char_To_String(member_header_1.sas_dsname);
+				}
+				if (!Read(member_header_2)) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				member.label = internal::Char_To_String(member_header_2.dslabel);
+				member.header = member_header_1;
+				member.header_2 = member_header_2;
+
+				if (!Read(hdr)) {
+					return NStatus::Unexpected_EOF;
+				}
+				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Namestr) {
+					return NStatus::No_Namestr_Header;
+				}
+
+				size_t readCnt = 0;
+				member.record_length = 0;
+				member.variables.clear();
+				const size_t cnt = internal::Parse_Variable_Count(hdr, mFormat_Version);
+
+				// read all variable descriptors ("namestrs") and store them in minimal, internal representation
+				for (size_t i = 0; i < cnt; i++) {
+
+					// the shorter (VAX/VMS) descriptors lack the end of the padding, so the second part is read just partially
+					internal::Namestr_Record_1 namestr1;
+					internal::Namestr_Record_2 namestr2{};
+					const size_t namestr2_size = namestr_size - sizeof(internal::Namestr_Record_1);
+					if (!Read<internal::Namestr_Record_1, false>(namestr1) || mSource->Read(reinterpret_cast<std::byte*>(&namestr2), namestr2_size) != namestr2_size) {
+						return NStatus::Unexpected_EOF;
+					}
+
+					readCnt += namestr_size;
+
+					auto varLength = static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr1.nlng));
+					const auto varType = static_cast<NVar_Type>(internal::To_Machine_Endian_Raw(namestr1.ntype));
+
+					// numeric values may be truncated down to 2 bytes, but never longer than a double
+					internal::NDecode_Kind decode = internal::NDecode_Kind::String;
+					if (varType == NVar_Type::Numeric) {
+						if (varLength < 2 || varLength > 8) {
+							return NStatus::Invalid_Variable;
+						}
+						decode = (varLength == 8) ? internal::NDecode_Kind::Number : internal::NDecode_Kind::Short_Number;
+					}
+
+					member.variables.emplace_back(
+						std::string{ internal::Namestr_Name(namestr1, namestr2, mFormat_Version) },
+						internal::Char_To_String(namestr1.nlabel),
+						varType,
+						varLength,
+						static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr1.nvar0)),
+						static_cast<size_t>(internal::To_Machine_Endian_Raw(namestr2.npos)),
+						decode,
+						namestr1,
+						namestr2
+					);
+
+					// increase row length
+					member.record_length += varLength;
+				}
+
+				// padding - discard empty spaces
+				const size_t rest = readCnt % 80;
+				if (rest != 0) {
+					Read_Discard(80 - rest);
+				}
+
+				if (!Read(hdr)) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				// labels longer than 40 characters (and long format names) of V8 files follow in the label records
+				const auto label_signature = Recognize_Data_Header(hdr);
+				if (label_signature == internal::Header_Signature::Label || label_signature == internal::Header_Signature::Label_V9) {
+					const NStatus status = Read_Label_Records(member, internal::Parse_Label_Count(hdr), label_signature == internal::Header_Signature::Label_V9);
+					if (status != NStatus::Ok) {
+						return status;
+					}
+					if (!Read(hdr)) {
+						return NStatus::Unexpected_EOF;
+					}
+				}
+
+				// expect the observation header as last header
+				if (Recognize_Data_Header(hdr) != internal::Header_Signature::Observation) {
+					return NStatus::No_Observation_Header;
+				}
+
+				member.stated_row_count = internal::Parse_Observation_Count(hdr, mFormat_Version);
+				member.data_offset = mSource->Tell();
+				return NStatus::Ok;
+			}
+
+			// reads a given count of entries of the label records, and stores the labels (and format names) to the variables of the member
+			NStatus Read_Label_Records(Member_Info& member, size_t count, bool v9) {
+
+				std::vector<std::byte> entry_data;
+				size_t read_count = 0;
+
+				for (size_t i = 0; i < count; i++) {
+					internal::Label_Entry entry;
+					size_t size = 0;
+
+					// the fixed part of the entry determines the size of the rest
+					if (!Read(entry_data, internal::Label_Entry_Header_Size(v9))) {
+						return NStatus::Unexpected_EOF;
+					}
+					internal::Parse_Label_Entry(entry_data, 0, v9, entry, size);
+
+					entry_data.resize(size);
+					const size_t rest = size - internal::Label_Entry_Header_Size(v9);
+					if (mSource->Read(entry_data.data() + internal::Label_Entry_Header_Size(v9), rest) != rest) {
+						return NStatus::Unexpected_EOF;
+					}
+					internal::Parse_Label_Entry(entry_data, 0, v9, entry, size);
+					read_count += size;
+
+					auto itr = std::find_if(member.variables.begin(), member.variables.end(), [&entry](const Variable_Record& var) {
+						return var.varNum == entry.number;
+					});
+					if (itr == member.variables.end()) {
+						continue;
+					}
+
+					if (!entry.name.empty()) {
+						itr->name = entry.name;
+					}
+					itr->label = entry.label;
+					itr->format_name = entry.format;
+					itr->informat_name = entry.informat;
+				}
+
+				// padding - discard empty spaces
+				const size_t rest = read_count % 80;
+				if (rest != 0) {
+					Read_Discard(80 - rest);
+				}
+
+				return NStatus::Ok;
+			}
+
+			// recognized data header based on its signature; the headers must be of the version of the library header
+			internal::Header_Signature Recognize_Data_Header(const internal::Data_Header_Generic& gen) const {
+				return internal::Recognize_Signature(std::string_view{ gen.namedesc, sizeof(gen.namedesc) }, mFormat_Version);
+			}
+
+			// retrieves the raw IBM value of a numeric variable from the row
+			static uint64_t Fetch_Number(std::span<const std::byte> data, const Variable_Record& mvar) {
+				if (mvar.decode == internal::NDecode_Kind::Number) {
+					return internal::Get_From_Buffer<uint64_t>(data, mvar.position);
+				}
+				return internal::Get_Number_From_Buffer(data, mvar.position, mvar.length);
+			}
+
+			// fetches the column by its ID. The parameter must match the column type, otherwise the column value is converted (an in case of invalid type, an exception may be raised according to standard library rules)
+			template<typename Arg0>
+			void Fetch_Column_Idx(std::span<const std::byte> data, size_t argIdx, Arg0& arg) {
+
+				const auto& mvar = mVariables[mSelection[argIdx]];
+				XPTLIB_STATS((mvar.type == NVar_Type::Numeric ? mStats.numeric_values : mStats.string_values)++);
+
+				// is the parameter a numeric type (double precision)? fetch number
+				if constexpr (std::is_same_v<std::decay_t<Arg0>, double>) {
+					if (mvar.type == NVar_Type::Numeric) {
+						arg = internal::IbmToIEEE(Fetch_Number(data, mvar));
+					}
+					else {
+						arg = std::stod(internal::Get_From_Buffer(data, mvar.position, mvar.length));
+					}
+				}
+				// is the parameter a string view? point it to the row buffer (numeric columns cannot be viewed this way)
+				else if constexpr (std::is_same_v<std::decay_t<Arg0>, std::string_view>) {
+					if (mvar.type == NVar_Type::String) {
+						arg = internal::Get_View_From_Buffer(data, mvar.position, mvar.length);
+					}
+					else {
+						throw std::invalid_argument{ "Numeric column cannot be retrieved as a string view" };
+					}
+				}
+				// otherwise fetch a string
+				else {
+					if (mvar.type == NVar_Type::String) {
+						arg = internal::Get_View_From_Buffer(data, mvar.position, mvar.length);
+					}
+					else {
+						arg = std::to_string(internal::IbmToIEEE(Fetch_Number(data, mvar)));
+					}
+				}
+			}
+
+			// recursion stop method to fetch the last column
+			template<typename Arg0>
+			void Fetch_Column(std::span<const std::byte> data, const size_t origCnt, Arg0& arg) {
+				Fetch_Column_Idx(data, origCnt - 1, arg);
+			}
+
+			// variadic method to retrieve columns to given parameters with known types
+			template<typename Arg0, typename... Args>
+			void Fetch_Column(std::span<const std::byte> data, const size_t origCnt, Arg0& arg, Args&... args) {
+
+				const size_t i = origCnt - (sizeof...(Args) + 1);
+
+				Fetch_Column_Idx(data, i, arg);
+				Fetch_Column(data, origCnt, args...);
+			}
+
+		public:
+			File() = default;
+			virtual ~File() = default;
+
+			/**
+			 * Opens the given file, checks for existence implicitly
+			 * Returns true on success, false on failure (file does not exist, insufficient rights, ...)
+			 */
+			bool Open(const std::filesystem::path& path) {
+				auto source = std::make_unique<internal::Stream_Source>();
+				if (!source->Open(path)) {
+					return false;
+				}
+
+				mSource = std::move(source);
+				mPath = path;
+				return true;
+			}
+
+			/**
+			 * Opens the file contents stored in memory; the contents are parsed directly from the buffer without copying, so the buffer
+			 * must stay valid (and unmodified) as long as the file is being read
+			 * Returns true on success, false if the buffer is empty
+			 */
+			bool Open(std::span<const std::byte> buffer) {
+				if (buffer.empty()) {
+					return false;
+				}
+
+				mSource = std::make_unique<internal::Memory_Source>(buffer);
+				mPath.clear();
+				return true;
+			}
+
+			/**
+			 * Opens the file contents read from a given stream, starting at its current position; the stream is not owned, so it must stay
+			 * valid as long as the file is being read. Random access and row count are available only if the stream supports seeking,
+			 * and parallel scans are not available at all
+			 * Returns true on success, false if the stream is in a failed state
+			 */
+			bool Open(std::istream& stream) {
+				if (!stream) {
+					return false;
+				}
+
+				mSource = std::make_unique<internal::Istream_Source>(stream);
+				mPath.clear();
+				return true;
+			}
+
+			/**
+			 * Opens a custom source of the file contents, e.g., a decompressor or a network stream; only Read, Skip and Tell are required,
+			 * seeking, size and cloning of the source enable the random access, row count and parallel scans, respectively
+			 * Returns true on success, false if no source was given
+			 */
+			bool Open(std::unique_ptr<Input_Source> source) {
+				if (!source) {
+					return false;
+				}
+
+				mSource = std::move(source);
+				mPath.clear();
+				return true;
+			}
+
+			/**
+			 * Opens the given file, which may be compressed by gzip or zstd (recognized by the contents, not the extension); the file is
+			 * decompressed on the fly in a background thread, so the decompression overlaps with decoding. Uncompressed files are opened as by Open
+			 * Compressed files are supported only if the header was included with XPTLIB_WITH_ZLIB and/or XPTLIB_WITH_ZSTD defined
+			 * Returns true on success, false on failure (file does not exist, insufficient rights, unsupported compression, ...)
+			 */
+			bool Open_Compressed(const std::filesystem::path& path) {
+				std::array<unsigned char, 4> magic{};
+				{
+					std::ifstream probe(path, std::ios::in | std::ios::binary);
+					if (!probe.is_open()) {
+						return false;
+					}
+					probe.read(reinterpret_cast<char*>(magic.data()), magic.size());
+				}
+
+				std::unique_ptr<Input_Source> source;
+
+				if (magic[0] == 0x1f && magic[1] == 0x8b) {
+#if defined(XPTLIB_WITH_ZLIB)
+					auto gzip = std::make_unique<internal::Gzip_Source>();
+					if (!gzip->Open(path)) {
+						return false;
+					}
+					source = std::move(gzip);
+#else
+					return false;
+#endif
+				}
+				else if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#if defined(XPTLIB_WITH_ZSTD)
+					auto zstd = std::make_unique<internal::Zstd_Source>();
+					if (!zstd->Open(path)) {
+						return false;
+					}
+					source = std::move(zstd);
+#else
+					return false;
+#endif
+				}
+				else {
+					return Open(path);
+				}
+
+				if (!Open(std::make_unique<internal::Prefetch_Source>(std::move(source), 1024 * 1024, 4))) {
+					return false;
+				}
+
+				mPath = path;
+				return true;
+			}
+
+			/**
+			 * Opens the given file by mapping it to memory; the headers and rows are then parsed directly from the mapped pages without copying
+			 * Returns true on success, false on failure (file does not exist, insufficient rights, platform does not support memory mapping, ...)
+			 */
+			bool Open_Mapped(const std::filesystem::path& path) {
+#if defined(XPTLIB_HAS_MMAP)
+				auto mapping = std::make_shared<internal::Memory_Mapping>();
+				if (!mapping->Open(path)) {
+					return false;
+				}
+
+				const auto data = mapping->Data();
+				mSource = std::make_unique<internal::Memory_Source>(data, std::move(mapping));
+				mPath = path;
+				return true;
+#else
+				(void)path;
+				return false;
+#endif
+			}
+
+			/**
+			 * Opens the given file for reading with a background I/O thread, which reads chunks of a given size ahead into a ring of
+			 * queue_depth buffers, while the caller decodes the data already read; suitable mainly for network and other high-latency storage
+			 * Returns true on success, false on failure (file does not exist, insufficient rights, ...)
+			 */
+			bool Open_Prefetched(const std::filesystem::path& path, size_t chunk_size = 4 * 1024 * 1024, size_t queue_depth = 4) {
+				auto source = std::make_unique<internal::Stream_Source>();
+				if (!source->Open(path)) {
+					return false;
+				}
+
+				mSource = std::make_unique<internal::Prefetch_Source>(std::move(source), chunk_size, queue_depth);
+				mPath = path;
+				return true;
+			}
+
+			/**
+			 * Reads the file headers, variables and other meta-information; this must be done prior to Read_Next call
+			 * Only the first member (dataset) of the library is read; its rows end at the header of the next member, or at the end of file.
+			 * Just the headers are read - if the count of rows is not stated by the header, the reads stop at the next member, and the rows
+			 * are searched for it only once the count is needed (see Row_Count). Use Read_Member_Index to read the other members
+			 * Returns NStatus::Ok on success, or other codes if an error has occurred
+			 */
+			NStatus Read_Headers() {
+
+				mMembers.clear();
+				mRow_Count_Pending = false;
+
+				if (mSource && mSource->Tell() != 0 && !mSource->Seek(0)) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				NStatus status = Read_Library_Header();
+				if (status != NStatus::Ok) {
+					return status;
+				}
+
+				Member_Info member;
+				status = Read_Member_Headers(member);
+				if (status != NStatus::Ok) {
+					return status;
+				}
+
+				mVariables = std::move(member.variables);
+				mMember_Header = member.header;
+				mMember_Header_2 = member.header_2;
+				mDataset_Name = member.name;
+				mRecord_Len = member.record_length;
+				mData_Offset = member.data_offset;
+				mNext_Row = 0;
+
+				// all columns are retrieved by default, and all rows
+				Select_All();
+				mFilter.clear();
+				mDictionary_Encoded.assign(mVariables.size(), false);
+				mZone_Rows = 0;
+				mZones.clear();
+
+				// the count of rows stated by the header (V8 files) is exact, as long as the rows fit to the file - the rows then need not
+				// extend to the end of file, and the count is known even for streamed sources
+				const size_t source_size = mSource->Size();
+				if (member.stated_row_count != 0 && (source_size == 0 || mData_Offset + member.stated_row_count * mRecord_Len <= source_size)) {
+					mRow_Count = member.stated_row_count;
+				}
+				else {
+					// the rows must not extend to the next member of a library, but it is not searched for here, so just the headers
+					// are read; the reads stop at it, and the rows are searched for it only when the count is needed (see mRow_Count_Pending)
+					mRow_Count = Count_Rows(mData_Offset, source_size, mRecord_Len);
+					mRow_Count_Pending = mRow_Count.has_value();
+					if (!mSource->Seek(mData_Offset)) {
+						mRow_Count.reset();
+						mRow_Count_Pending = false;
+					}
+				}
+
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Reads just the metadata (dataset name and label, variables) of the first member of the library, without preparing the file
+			 * for reading rows; the header region is read using a single I/O call (two for files with more than ~110 variables),
+			 * and parsed to a compact representation. Use Read_Headers to read the rows
+			 * Returns NStatus::Ok on success, or other codes if an error has occurred
+			 */
+			NStatus Read_Metadata(Metadata& metadata) {
+
+				// covers the headers of files with up to ~110 variables
+				constexpr size_t Initial_Size = 16 * 1024;
+
+				if (!mSource || (mSource->Tell() != 0 && !mSource->Seek(0))) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				auto buffer = mSource->Fetch(Initial_Size, mBatch_Buffer);
+
+				size_t required = 0;
+				size_t requested = Initial_Size;
+				NStatus status = metadata.Parse(buffer, required);
+
+				// the size of the header region is known now, so read it whole (directly, if the source supports seeking); the label records
+				// of V8 files have variable sizes, so the required size may grow again while they are parsed
+				std::vector<std::byte> whole;
+				while (status == NStatus::Unexpected_EOF && buffer.size() == requested && required > requested) {
+					if (whole.empty() && mSource->Seek(0)) {
+						buffer = mSource->Fetch(required, mBatch_Buffer);
+					}
+					else {
+						if (whole.empty()) {
+							whole.assign(buffer.begin(), buffer.end());
+						}
+						const size_t available = whole.size();
+						whole.resize(required);
+						if (mSource->Read(whole.data() + available, required - available) != required - available) {
+							return NStatus::Unexpected_EOF;
+						}
+						buffer = whole;
+					}
+
+					requested = required;
+					status = metadata.Parse(buffer, required);
+				}
+
+				return status;
+			}
+
+			/**
+			 * Builds the index of all members (datasets) of the library file in a single pass over the headers - the rows are not decoded,
+			 * the observation sections are only searched for the next member header; the source must support seeking
+			 * The first member is then opened for reading, as if Select_Member(0) was called
+			 * Returns NStatus::Ok on success, or other codes if an error has occurred
+			 */
+			NStatus Read_Member_Index() {
+
+				mMembers.clear();
+
+				if (!mSource || (mSource->Tell() != 0 && !mSource->Seek(0))) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				NStatus status = Read_Library_Header();
+				if (status != NStatus::Ok) {
+					return status;
+				}
+
+				std::vector<Member_Info> members;
+				bool next_member = true;
+
+				while (next_member) {
+					Member_Info member;
+					status = Read_Member_Headers(member);
+					if (status != NStatus::Ok) {
+						return status;
+					}
+
+					// the observation section ends where the next member starts, or at the end of file; if the count of rows is stated
+					// by the header (V8 files), the end is known, so the rows are not searched
+					size_t data_end = member.data_offset + (member.stated_row_count * member.record_length + 79) / 80 * 80;
+					if (member.stated_row_count != 0 && Is_Member_End(data_end, next_member)) {
+						member.row_count = member.stated_row_count;
+					}
+					else {
+						data_end = Find_Member_End(member.data_offset, next_member);
+						member.row_count = Count_Rows(member.data_offset, data_end, member.record_length).value_or(0);
+					}
+					members.push_back(std::move(member));
+
+					if (next_member && !mSource->Seek(data_end)) {
+						return NStatus::Unexpected_EOF;
+					}
+				}
+
+				mMembers = std::move(members);
+				return Select_Member(0);
+			}
+
+			/**
+			 * Retrieves the member index built by Read_Member_Index (it is empty if the index was not built)
+			 */
+			const std::vector<Member_Info>& Get_Members() const {
+				return mMembers;
+			}
+
+			/**
+			 * Retrieves the name of the dataset (member) being read
+			 */
+			std::string Get_Dataset_Name() const {
+				return mDataset_Name;
+			}
+
+			/**
+			 * Retrieves the label of the dataset being read
+			 */
+			std::string Get_Dataset_Label() const {
+				return internal::Char_To_String(mMember_Header_2.dslabel);
+			}
+
+			/**
+			 * Retrieves the type of the dataset being read (mostly empty)
+			 */
+			std::string Get_Dataset_Type() const {
+				return internal::Char_To_String(mMember_Header_2.dstype);
+			}
+
+			/**
+			 * Retrieves the date and time of creation of the dataset being read; std::nullopt if the header does not contain a valid date
+			 */
+			std::optional<Date_Time> Get_Dataset_Created() const {
+				return Date_Time::Decode(mMember_Header.created);
+			}
+
+			/**
+			 * Retrieves the date and time of the last modification of the dataset being read
+			 */
+			std::optional<Date_Time> Get_Dataset_Modified() const {
+				return Date_Time::Decode(mMember_Header_2.modified_at);
+			}
+
+			/**
+			 * Retrieves the version of SAS, which created the dataset being read
+			 */
+			std::string Get_SAS_Version() const {
+				return internal::Char_To_String(mMember_Header.sasver);
+			}
+
+			/**
+			 * Retrieves the name of the operating system, on which the dataset being read was created
+			 */
+			std::string Get_OS_Name() const {
+				return internal::Char_To_String(mMember_Header.sas_osname);
+			}
+
+			/**
+			 * Retrieves the date and time of creation of the library file
+			 */
+			std::optional<Date_Time> Get_Library_Created() const {
+				return Date_Time::Decode(mFile_Header.created);
+			}
+
+			/**
+			 * Retrieves the date and time of the last modification of the library file
+			 */
+			std::optional<Date_Time> Get_Library_Modified() const {
+				return Date_Time::Decode(mLibrary_Modified);
+			}
+
+			/**
+			 * Retrieves the version of the transport format of the file (V5, or V8 with long names and labels)
+			 */
+			NFormat_Version Get_Format_Version() const {
+				return mFormat_Version;
+			}
+
+			/**
+			 * Opens a member of the library for reading, by its position in the index built by Read_Member_Index; the rows are then read
+			 * from the first row of the member, and all its columns are selected
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Member if there is no such member, or NStatus::Unexpected_EOF if the source cannot be positioned
+			 */
+			NStatus Select_Member(size_t index) {
+				if (index >= mMembers.size()) {
+					return NStatus::No_Such_Member;
+				}
+
+				const auto& member = mMembers[index];
+				if (!mSource || !mSource->Seek(member.data_offset)) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				mVariables = member.variables;
+				mMember_Header = member.header;
+				mMember_Header_2 = member.header_2;
+				mDataset_Name = member.name;
+				mFormat_Version = member.version;
+				mRecord_Len = member.record_length;
+				mData_Offset = member.data_offset;
+				mRow_Count = member.row_count;
+				mRow_Count_Pending = false;
+				mNext_Row = 0;
+				mZone_Rows = member.zone_rows;
+				mZones = member.zones;
+				Select_All();
+				mFilter.clear();
+				mDictionary_Encoded.assign(mVariables.size(), false);
+
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Opens a member of the library for reading, by its name
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Member if there is no such member, or NStatus::Unexpected_EOF if the source cannot be positioned
+			 */
+			NStatus Select_Member(std::string_view name) {
+				auto itr = std::find_if(mMembers.begin(), mMembers.end(), [name](const Member_Info& member) {
+					return member.name == name;
+				});
+				if (itr == mMembers.end()) {
+					return NStatus::No_Such_Member;
+				}
+
+				return Select_Member(static_cast<size_t>(itr - mMembers.begin()));
+			}
+
+			/**
+			 * Builds the member index (see Read_Member_Index) and zone maps of all numeric variables - minimum and maximum of each block
+			 * of rows_per_block rows - and stores them to a sidecar index file. The index is bound to the size and modification time of the file,
+			 * and to the hash of its headers, so it can be loaded by Read_Index instead of reading the headers, as long as the file is not modified
+			 * The zone maps let the filtered reads (see Set_Filter) skip whole blocks of rows, which cannot meet the numeric conditions
+			 * Afterwards, the first member is selected (as by Read_Member_Index)
+			 * Returns NStatus::Ok on success, NStatus::Invalid_Index if the file was not opened from a path, NStatus::Write_Error if the
+			 * index cannot be written, or other codes if the headers cannot be read
+			 */
+			NStatus Write_Index(const std::filesystem::path& index_path, size_t rows_per_block = 65536) {
+
+				uint64_t file_size = 0;
+				int64_t modified = 0;
+				if (mPath.empty() || rows_per_block == 0 || !Index_Key(file_size, modified)) {
+					return NStatus::Invalid_Index;
+				}
+
+				NStatus status = Read_Member_Index();
+				if (status != NStatus::Ok) {
+					return status;
+				}
+
+				// zone maps are built by reading all rows of each member, in blocks
+				for (size_t m = 0; m < mMembers.size(); m++) {
+					if ((status = Select_Member(m)) != NStatus::Ok) {
+						return status;
+					}
+
+					auto& member = mMembers[m];
+					member.zone_rows = rows_per_block;
+					member.zones.assign(member.variables.size(), {});
+
+					Column_Batch batch;
+					while (Read_Batch(rows_per_block, batch) > 0) {
+						for (const auto& col : batch.columns) {
+							if (col.type != NVar_Type::Numeric) {
+								continue;
+							}
+
+							internal::Value_Summary summary;
+							internal::Summarize(col.numbers.data(), batch.rows, summary);
+							member.zones[col.variable].push_back({ summary.min, summary.max, static_cast<uint8_t>(summary.count < batch.rows ? 1 : 0) });
+						}
+					}
+				}
+
+				const auto header_size = mMembers.empty() ? 0 : mMembers[0].data_offset;
+				const auto header_hash = Hash_Headers(header_size);
+				if (!header_hash.has_value()) {
+					return NStatus::Unexpected_EOF;
+				}
+
+				internal::Index_Writer writer;
+				writer.Put(internal::Index_Magic);
+				writer.Put(internal::Index_Version);
+				writer.Put(internal::Index_Byte_Order);
+				writer.Put(file_size);
+				writer.Put(modified);
+				writer.Put<uint64_t>(header_size);
+				writer.Put(*header_hash);
+				writer.Put(mFile_Header);
+				writer.Put(mLibrary_Modified);
+
+				writer.Put<uint64_t>(mMembers.size());
+				for (const auto& member : mMembers) {
+					writer.Put_String(member.name);
+					writer.Put_String(member.label);
+					writer.Put<uint64_t>(member.record_length);
+					writer.Put<uint64_t>(member.data_offset);
+					writer.Put<uint64_t>(member.row_count);
+					writer.Put(member.version);
+					writer.Put(member.header);
+					writer.Put(member.header_2);
+
+					writer.Put<uint64_t>(member.variables.size());
+					for (const auto& var : member.variables) {
+						writer.Put_String(var.name);
+						writer.Put_String(var.label);
+						writer.Put(var.type);
+						writer.Put<uint64_t>(var.length);
+						writer.Put<uint64_t>(var.varNum);
+						writer.Put<uint64_t>(var.position);
+						writer.Put(var.decode);
+						writer.Put(var.namestr);
+						writer.Put(var.namestr_2);
+						writer.Put_String(var.format_name);
+						writer.Put_String(var.informat_name);
+					}
+
+					writer.Put<uint64_t>(member.zone_rows);
+					writer.Put<uint64_t>(member.zones.size());
+					for (const auto& zones : member.zones) {
+						writer.Put<uint64_t>(zones.size());
+						for (const auto& zone : zones) {
+							writer.Put(zone.min);
+							writer.Put(zone.max);
+							writer.Put(zone.has_missing);
+						}
+					}
+				}
+
+				// the checksum of the contents lets Read_Index detect a damaged index
+				writer.Put(internal::Hash_Bytes(std::string_view{ reinterpret_cast<const char*>(writer.data.data()), writer.data.size() }));
+
+				std::ofstream out(index_path, std::ios::out | std::ios::binary | std::ios::trunc);
+				out.write(reinterpret_cast<const char*>(writer.data.data()), static_cast<std::streamsize>(writer.data.size()));
+				out.close();
+				if (!out) {
+					return NStatus::Write_Error;
+				}
+
+				return Select_Member(0);
+			}
+
+			/**
+			 * Loads the member index and zone maps from a sidecar index file written by Write_Index, instead of reading the headers;
+			 * only the headers are read from the file, to verify the hash. Afterwards, the first member is selected (as by Read_Member_Index)
+			 * Returns NStatus::Ok on success, or NStatus::Invalid_Index if the index does not exist, is corrupted (its checksum does not match,
+			 * or the variables, rows or zone maps it describes do not fit the records of the file), or does not match the file (e.g., the file
+			 * was modified since the index was written); the headers should then be read as usual
+			 */
+			NStatus Read_Index(const std::filesystem::path& index_path) {
+
+				uint64_t file_size = 0;
+				int64_t modified = 0;
+				if (mPath.empty() || !Index_Key(file_size, modified)) {
+					return NStatus::Invalid_Index;
+				}
+
+				std::vector<std::byte> contents;
+				{
+					std::ifstream in(index_path, std::ios::in | std::ios::binary | std::ios::ate);
+					if (!in.is_open()) {
+						return NStatus::Invalid_Index;
+					}
+					contents.resize(static_cast<size_t>(in.tellg()));
+					in.seekg(0);
+					if (!in.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()))) {
+						return NStatus::Invalid_Index;
+					}
+				}
+
+				// the contents are followed by their checksum
+				uint64_t checksum = 0;
+				if (contents.size() < sizeof(checksum)) {
+					return NStatus::Invalid_Index;
+				}
+				contents.resize(contents.size() - sizeof(checksum));
+				std::memcpy(&checksum, contents.data() + contents.size(), sizeof(checksum));
+				if (internal::Hash_Bytes(std::string_view{ reinterpret_cast<const char*>(contents.data()), contents.size() }) != checksum) {
+					return NStatus::Invalid_Index;
+				}
+
+				internal::Index_Reader reader{ contents };
+				if (reader.Get<std::array<char, 8>>() != internal::Index_Magic || reader.Get<uint32_t>() != internal::Index_Version
+					|| reader.Get<uint32_t>() != internal::Index_Byte_Order || reader.Get<uint64_t>() != file_size || reader.Get<int64_t>() != modified) {
+					return NStatus::Invalid_Index;
+				}
+
+				const auto header_size = reader.Get<uint64_t>();
+				const auto header_hash = reader.Get<uint64_t>();
+				const auto file_header = reader.Get<internal::File_Header_Record>();
+				const auto library_modified = reader.Get<internal::Date_Time_Record>();
+				if (reader.failed || header_size > file_size || Hash_Headers(static_cast<size_t>(header_size)) != header_hash) {
+					return NStatus::Invalid_Index;
+				}
+
+				std::vector<Member_Info> members(reader.Get_Count(sizeof(uint64_t)));
+				for (auto& member : members) {
+					member.name = reader.Get_String();
+					member.label = reader.Get_String();
+					member.record_length = static_cast<size_t>(reader.Get<uint64_t>());
+					member.data_offset = static_cast<size_t>(reader.Get<uint64_t>());
+					member.row_count = static_cast<size_t>(reader.Get<uint64_t>());
+					member.version = reader.Get<NFormat_Version>();
+					member.header = reader.Get<internal::Member_Header_Record>();
+					member.header_2 = reader.Get<internal::Member_Header_Record_2>();
+
+					member.variables.resize(reader.Get_Count(sizeof(uint64_t)));
+					for (auto& var : member.variables) {
+						var.name = reader.Get_String();
+						var.label = reader.Get_String();
+						var.type = reader.Get<NVar_Type>();
+						var.length = static_cast<size_t>(reader.Get<uint64_t>());
+						var.varNum = static_cast<size_t>(reader.Get<uint64_t>());
+						var.position = static_cast<size_t>(reader.Get<uint64_t>());
+						var.decode = reader.Get<internal::NDecode_Kind>();
+						var.namestr = reader.Get<internal::Namestr_Record_1>();
+						var.namestr_2 = reader.Get<internal::Namestr_Record_2>();
+						var.format_name = reader.Get_String();
+						var.informat_name = reader.Get_String();
+					}
+
+					member.zone_rows = static_cast<size_t>(reader.Get<uint64_t>());
+					member.zones.resize(reader.Get_Count(sizeof(uint64_t)));
+					for (auto& zones : member.zones) {
+						zones.resize(reader.Get_Count(internal::Block_Zone::Serialized_Size));
+						for (auto& zone : zones) {
+							zone.min = reader.Get<double>();
+							zone.max = reader.Get<double>();
+							zone.has_missing = reader.Get<uint8_t>();
+						}
+					}
+
+					// the zone maps must cover the variables (the filter looks them up by the variable index)
+					if (member.zone_rows != 0 && member.zones.size() != member.variables.size()) {
+						reader.failed = true;
+					}
+					if (!reader.failed && !Is_Consistent(member, file_size)) {
+						reader.failed = true;
+					}
+					if (reader.failed) {
+						return NStatus::Invalid_Index;
+					}
+				}
+
+				if (reader.failed || members.empty()) {
+					return NStatus::Invalid_Index;
+				}
+
+				mFile_Header = file_header;
+				mLibrary_Modified = library_modified;
+				mMembers = std::move(members);
+				return Select_Member(0);
+			}
+
+			/**
+			 * Reads next row and pushes the result to target vector
+			 * String values already present in the target vector are reused, so their storage is not reallocated when not needed
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
+			 */
+			bool Read_Next(std::vector<TValue>& target) {
+
+				target.resize(mSelection.size());
+
+				std::span<const std::byte> row;
+				if (!Fetch_Matching_Row(row)) {
+					return false;
+				}
+
+				XPTLIB_STATS(const auto decode_start = internal::Stats_Clock::now());
+
+				// read the whole row into a vector
+				for (size_t i = 0; i < mSelection.size(); i++) {
+
+					const auto& mvar = mVariables[mSelection[i]];
+
+					if (mvar.type == NVar_Type::Numeric) {
+						target[i] = internal::IbmToIEEE(Fetch_Number(row, mvar));
+					}
+					else if (mvar.type == NVar_Type::String) {
+						const auto view = internal::Get_View_From_Buffer(row, mvar.position, mvar.length);
+						if (auto* str = std::get_if<std::string>(&target[i])) {
+							str->assign(view);
+						}
+						else {
+							target[i].emplace<std::string>(view);
+						}
+					}
+				}
+
+				XPTLIB_STATS(Count_Row_Decode(decode_start));
+				return true;
+			}
+
+			/**
+			 * Reads next row and pushes the result to target vector of non-owning values
+			 * String values point to the internal row buffer and are valid only until the next read from this file
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
+			 */
+			bool Read_Next(std::vector<TValue_View>& target) {
+
+				target.resize(mSelection.size());
+
+				std::span<const std::byte> row;
+				if (!Fetch_Matching_Row(row)) {
+					return false;
+				}
+
+				XPTLIB_STATS(const auto decode_start = internal::Stats_Clock::now());
+
+				for (size_t i = 0; i < mSelection.size(); i++) {
+
+					const auto& mvar = mVariables[mSelection[i]];
+
+					if (mvar.type == NVar_Type::Numeric) {
+						target[i] = internal::IbmToIEEE(Fetch_Number(row, mvar));
+					}
+					else if (mvar.type == NVar_Type::String) {
+						target[i] = internal::Get_View_From_Buffer(row, mvar.position, mvar.length);
+					}
+				}
+
+				XPTLIB_STATS(Count_Row_Decode(decode_start));
+				return true;
+			}
+
+			/**
+			 * Reads next row and pushes the result to target vector of compact cells; string values are copied to the given arena,
+			 * so they remain valid until the arena is reset (and many rows can be kept without allocating a string for each value)
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
+			 */
+			bool Read_Next(std::vector<Cell>& target, String_Arena& arena) {
+
+				target.resize(mSelection.size());
+
+				std::span<const std::byte> row;
+				if (!Fetch_Matching_Row(row)) {
+					return false;
+				}
+
+				XPTLIB_STATS(const auto decode_start = internal::Stats_Clock::now());
+				Decode_Cells(row, target.data(), arena);
+				XPTLIB_STATS(Count_Row_Decode(decode_start));
+
+				return true;
+			}
+
+			/**
+			 * Reads up to max_rows next rows and appends them to the block of cells; string values are stored to the arena of the block
+			 * The rows of a block must have the same columns, so if the block already holds rows of a different count of columns (the selection
+			 * was changed since), std::invalid_argument is thrown and the block is left intact; it must be cleared (see Row_Block::Clear) first
+			 * Returns the count of rows read, zero when an EOF occurred (there are no more records in the file)
+			 */
+			size_t Read_Rows(size_t max_rows, Row_Block& block) {
+
+				if (block.rows != 0 && block.columns != mSelection.size()) {
+					throw std::invalid_argument{ "Row block holds rows of a different count of columns" };
+				}
+				block.columns = mSelection.size();
+
+				size_t row_count = 0;
+				std::span<const std::byte> row;
+				for (; row_count < max_rows && Fetch_Matching_Row(row); row_count++) {
+					XPTLIB_STATS(const auto decode_start = internal::Stats_Clock::now());
+
+					block.cells.resize(block.cells.size() + block.columns);
+					Decode_Cells(row, block.cells.data() + block.rows * block.columns, block.arena);
+					block.rows++;
+
+					XPTLIB_STATS(Count_Row_Decode(decode_start));
+				}
+
+				return row_count;
+			}
+
+			/**
+			 * Reads next row and stores the result to target parameters of known type
+			 * Please note, that if the parameter type does not match the column type, the value is converted by the
+			 * internal rule set (standard library std::stod or std::to_string).
+			 * Parameters of type std::string_view point to the internal row buffer and are valid only until the next read from this file
+			 * Parameters are passed from 0 to N-1 of the selected columns (see Select), so e.g., if the user specifies only 3 parameters out of 5 columns in total, the last 2 columns are discarded
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
+			 */
+			template<typename... Args>
+			bool Read_Next(Args&... args) {
+
+				// store the original argument count, to properly assign values from left to right during recursion
+				const size_t originalArgCount = sizeof...(Args);
+
+				std::span<const std::byte> row;
+				if (!Fetch_Matching_Row(row)) {
+					return false;
+				}
+
+				XPTLIB_STATS(const auto decode_start = internal::Stats_Clock::now());
+				Fetch_Column(row, originalArgCount, args...);
+				XPTLIB_STATS(mStats.row_decode_ns += internal::Elapsed_Ns(decode_start); mStats.rows_decoded++);
+
+				return true;
+			}
+
+			/**
+			 * Decodes a given count of consecutive rows stored in the data buffer into the columnar batch
+			 */
+			void Decode_Batch(std::span<const std::byte> data, size_t row_count, Column_Batch& batch) const {
+				Decode_Batch(data, row_count, batch, mStats);
+			}
+
+		private:
+			// decodes the rows into the batch, collecting the statistics to a given target (see XPTLIB_STATS)
+			void Decode_Batch(std::span<const std::byte> data, size_t row_count, Column_Batch& batch, [[maybe_unused]] File_Stats& stats) const {
+
+				XPTLIB_STATS(stats.rows_decoded += row_count);
+
+				batch.rows = row_count;
+				batch.columns.resize(mSelection.size());
+
+				// the filter is evaluated on the raw rows first, so the strings of other rows need not be copied
+				batch.filtered = !mFilter.empty();
+				batch.selection.clear();
+				if (batch.filtered) {
+					for (size_t r = 0; r < row_count; r++) {
+						if (Matches_Filter(data.subspan(r * mRecord_Len, mRecord_Len))) {
+							batch.selection.push_back(static_cast<uint32_t>(r));
+						}
+					}
+				}
+
+				for (size_t i = 0; i < mSelection.size(); i++) {
+
+					const auto& mvar = mVariables[mSelection[i]];
+					auto& col = batch.columns[i];
+
+					// the dictionary is valid only for the variable it was built for
+					if (col.variable != mSelection[i] || col.type != mvar.type || !mDictionary_Encoded[mSelection[i]]) {
+						col.dictionary.Clear();
+					}
+					col.dictionary_encoded = false;
+					col.codes.clear();
+
+					col.variable = mSelection[i];
+					col.type = mvar.type;
+
+					if (mvar.type == NVar_Type::Numeric) {
+						col.numbers.resize(row_count);
+						col.validity.resize((row_count + 7) / 8);
+						col.missing.resize(row_count);
+						col.missing_count = 0;
+						col.offsets.clear();
+						col.bytes.clear();
+						col.fields = nullptr;
+
+						// gather the raw values to a small contiguous chunk and convert the whole chunk at once
+						constexpr size_t Chunk_Size = 256;
+						std::array<uint64_t, Chunk_Size> raw;
+
+						XPTLIB_STATS(const auto numeric_start = internal::Stats_Clock::now());
+
+						// truncated values are zero-extended when gathered, so the same conversion kernel serves all lengths
+						size_t pos = mvar.position;
+						for (size_t r = 0; r < row_count; r += Chunk_Size) {
+							const size_t cnt = std::min(Chunk_Size, row_count - r);
+							if (mvar.decode == internal::NDecode_Kind::Number) {
+								for (size_t j = 0; j < cnt; j++, pos += mRecord_Len) {
+									raw[j] = internal::Get_From_Buffer<uint64_t>(data, pos);
+								}
+							}
+							else {
+								for (size_t j = 0; j < cnt; j++, pos += mRecord_Len) {
+									raw[j] = internal::Get_Number_From_Buffer(data, pos, mvar.length);
+								}
+							}
+							internal::IbmToIEEE(raw.data(), col.numbers.data() + r, cnt);
+
+							// missing values are recognized while the chunk is still in cache
+							col.missing_count += internal::Extract_Missing(raw.data(), col.missing.data() + r, col.validity.data() + r / 8, cnt);
+						}
+
+						XPTLIB_STATS(stats.numeric_ns += internal::Elapsed_Ns(numeric_start); stats.numeric_values += row_count);
+					}
+					else if (mDictionary_Encoded[mSelection[i]]) {
+						col.numbers.clear();
+						col.validity.clear();
+						col.missing.clear();
+						col.missing_count = 0;
+						col.offsets.clear();
+						col.bytes.clear();
+						col.fields = nullptr;
+
+						XPTLIB_STATS(const auto string_start = internal::Stats_Clock::now());
+
+						// rows not meeting the filter get the code of the empty string
+						col.dictionary_encoded = true;
+						col.codes.resize(row_count);
+						size_t next_selected = 0;
+						for (size_t r = 0, pos = mvar.position; r < row_count; r++, pos += mRecord_Len) {
+							if (batch.filtered) {
+								if (next_selected == batch.selection.size() || batch.selection[next_selected] != r) {
+									col.codes[r] = col.dictionary.Intern({});
+									continue;
+								}
+								next_selected++;
+							}
+							col.codes[r] = col.dictionary.Intern(internal::Get_View_From_Buffer(data, pos, mvar.length));
+						}
+
+						XPTLIB_STATS(stats.string_ns += internal::Elapsed_Ns(string_start);
+							stats.string_values += batch.filtered ? batch.selection.size() : row_count);
+					}
+					else if (mLazy_Strings) {
+						col.numbers.clear();
+						col.validity.clear();
+						col.missing.clear();
+						col.missing_count = 0;
+						col.offsets.clear();
+						col.bytes.clear();
+
+						// the row data are just referenced; nothing is decoded until the values are accessed
+						col.fields = row_count != 0 ? reinterpret_cast<const char*>(data.data() + mvar.position) : nullptr;
+						col.field_stride = mRecord_Len;
+						col.field_length = mvar.length;
+					}
+					else {
+						col.numbers.clear();
+						col.validity.clear();
+						col.missing.clear();
+						col.missing_count = 0;
+						col.fields = nullptr;
+
+						XPTLIB_STATS(const auto string_start = internal::Stats_Clock::now());
+
+						col.offsets.resize(row_count + 1);
+						col.bytes.resize(row_count * mvar.length);
+
+						uint32_t offset = 0;
+						size_t next_selected = 0;
+						for (size_t r = 0, pos = mvar.position; r < row_count; r++, pos += mRecord_Len) {
+							col.offsets[r] = offset;
+
+							// rows not meeting the filter are left empty
+							if (batch.filtered) {
+								if (next_selected == batch.selection.size() || batch.selection[next_selected] != r) {
+									continue;
+								}
+								next_selected++;
+							}
+
+							const auto view = internal::Get_View_From_Buffer(data, pos, mvar.length);
+							std::copy(view.begin(), view.end(), col.bytes.begin() + offset);
+							offset += static_cast<uint32_t>(view.size());
+						}
+						col.offsets[row_count] = offset;
+						col.bytes.resize(offset);
+
+						XPTLIB_STATS(stats.string_ns += internal::Elapsed_Ns(string_start);
+							stats.string_values += batch.filtered ? batch.selection.size() : row_count);
+					}
+				}
+			}
+
+		public:
+
+			/**
+			 * Reads up to max_rows next rows into the columnar batch; numeric columns are stored as contiguous arrays of doubles
+			 * and string columns as offsets to a contiguous array of bytes. All rows are read from the file in a single bulk read
+			 * Returns the count of rows read, zero when an EOF occurred (there are no more records in the file)
+			 */
+			size_t Read_Batch(size_t max_rows, Column_Batch& batch) {
+
+				batch.rows = 0;
+				if (!mSource || mRecord_Len == 0) {
+					return 0;
+				}
+
+				// whole blocks not meeting the filter are skipped, so the batches must not cross the blocks
+				if (mZone_Rows != 0 && !mFilter.empty()) {
+					if (mNext_Row % mZone_Rows == 0) {
+						Skip_Blocks();
+					}
+					max_rows = std::min(max_rows, mZone_Rows - mNext_Row % mZone_Rows);
+				}
+
+				if (mRow_Count.has_value()) {
+					max_rows = std::min(max_rows, *mRow_Count - std::min(mNext_Row, *mRow_Count));
+				}
+
+				XPTLIB_STATS(const auto io_start = internal::Stats_Clock::now());
+				const auto data = mSource->Fetch(max_rows * mRecord_Len, mBatch_Buffer);
+				XPTLIB_STATS(mStats.io_ns += internal::Elapsed_Ns(io_start); mStats.read_calls++; mStats.bytes_read += data.size());
+
+				size_t row_count = data.size() / mRecord_Len;
+
+				// the rows may end at the next member within the data
+				if (mRow_Count_Pending) {
+					Check_Member_End(data.first(row_count * mRecord_Len), mData_Offset + mNext_Row * mRecord_Len);
+					if (mRow_Count.has_value()) {
+						row_count = std::min(row_count, *mRow_Count - std::min(mNext_Row, *mRow_Count));
+					}
+				}
+
+				Decode_Batch(data, row_count, batch);
+				mNext_Row += row_count;
+
+				return row_count;
+			}
+
+			/**
+			 * Exports the schema of the batches read by Read_Arrow_Batch, using the Arrow C data interface: a struct ("+s") of nullable fields
+			 * named after the selected variables. Numeric variables are exported as float64 ("g"), string variables as binary ("z"),
+			 * and dictionary-encoded string variables (see Set_Dictionary_Encoding) as int32 ("i") indices to a binary dictionary
+			 * The bytes of the strings are exported as they are stored in the file, which is usually in Latin-1 (or another single-byte
+			 * encoding), so they are not valid utf8 in general; if all the strings are known to be ASCII (or utf8), utf8_strings exports
+			 * them as utf8 ("u") instead. The schema is owned by the caller, which must release it by calling its release callback
+			 */
+			void Get_Arrow_Schema(ArrowSchema* out, bool utf8_strings = false) const {
+
+				const char* string_format = utf8_strings ? "u" : "z";
+
+				using THolder = internal::Arrow_Holder<ArrowSchema>;
+				auto holder = std::make_shared<THolder>();
+
+				const size_t count = mSelection.size();
+				holder->names.resize(count);
+				holder->children.resize(count);
+				holder->child_pointers.resize(count);
+				holder->dictionaries.resize(count);
+
+				for (size_t i = 0; i < count; i++) {
+					const size_t idx = mSelection[i];
+					auto& child = holder->children[i];
+
+					holder->names[i] = mVariables[idx].name;
+					if (mVariables[idx].type == NVar_Type::Numeric) {
+						internal::Fill_Arrow_Schema(child, "g", holder->names[i].c_str(), ARROW_FLAG_NULLABLE);
+					}
+					else if (mDictionary_Encoded[idx]) {
+						internal::Fill_Arrow_Schema(child, "i", holder->names[i].c_str(), ARROW_FLAG_NULLABLE);
+						internal::Fill_Arrow_Schema(holder->dictionaries[i], string_format, nullptr, ARROW_FLAG_NULLABLE);
+						internal::Share_Arrow(holder->dictionaries[i], holder);
+						child.dictionary = &holder->dictionaries[i];
+					}
+					else {
+						internal::Fill_Arrow_Schema(child, string_format, holder->names[i].c_str(), ARROW_FLAG_NULLABLE);
+					}
+					internal::Share_Arrow(child, holder);
+					holder->child_pointers[i] = &child;
+				}
+
+				internal::Fill_Arrow_Schema(*out, "+s", "", 0);
+				out->n_children = static_cast<int64_t>(count);
+				out->children = holder->child_pointers.data();
+				internal::Share_Arrow(*out, holder);
+			}
+
+			/**
+			 * Reads up to max_rows next rows (see Read_Batch) and exports them as a struct array using the Arrow C data interface
+			 * (see Get_Arrow_Schema for the schema). The buffers of the batch are handed over without copying; lazy strings are materialized,
+			 * and filtered batches are compacted to the rows meeting the filter. Each array carries its own dictionaries of the dictionary-encoded
+			 * columns, and remains valid after the subsequent reads; it is owned by the caller, which must release it by calling its release callback
+			 * Returns the count of rows exported (the length of the array), zero when an EOF occurred (out is then left released)
+			 */
+			size_t Read_Arrow_Batch(size_t max_rows, ArrowArray* out) {
+
+				out->release = nullptr;
+
+				using THolder = internal::Arrow_Holder<ArrowArray>;
+				auto holder = std::make_shared<THolder>();
+				auto& batch = holder->batch;
+
+				// batches with no rows meeting the filter are not exported
+				do {
+					if (Read_Batch(max_rows, batch) == 0) {
+						return 0;
+					}
+					batch.Materialize();
+					batch.Compact();
+				} while (batch.rows == 0);
+
+				static const char empty_bytes = '\0';
+
+				const size_t count = batch.columns.size();
+				holder->children.resize(count);
+				holder->child_pointers.resize(count);
+				holder->dictionaries.resize(count);
+				holder->buffers.resize(count);
+				holder->dictionary_buffers.resize(count);
+
+				for (size_t i = 0; i < count; i++) {
+					auto& col = batch.columns[i];
+					auto& child = holder->children[i];
+					auto& buffers = holder->buffers[i];
+
+					child = ArrowArray{};
+					child.length = static_cast<int64_t>(batch.rows);
+					child.buffers = buffers.data();
+
+					if (col.type == NVar_Type::Numeric) {
+						buffers = { col.validity.data(), col.numbers.data(), nullptr };
+						child.n_buffers = 2;
+						child.null_count = static_cast<int64_t>(col.missing_count);
+					}
+					else if (col.dictionary_encoded) {
+						buffers = { nullptr, col.codes.data(), nullptr };
+						child.n_buffers = 2;
+
+						auto& dictionary = holder->dictionaries[i];
+						dictionary = ArrowArray{};
+						dictionary.length = static_cast<int64_t>(col.dictionary.Size());
+						dictionary.n_buffers = 3;
+						auto& dictionary_buffers = holder->dictionary_buffers[i];
+						const auto bytes = col.dictionary.Bytes();
+						dictionary_buffers = { nullptr, col.dictionary.Offsets().data(), bytes.empty() ? &empty_bytes : bytes.data() };
+						dictionary.buffers = dictionary_buffers.data();
+						internal::Share_Arrow(dictionary, holder);
+						child.dictionary = &dictionary;
+					}
+					else {
+						buffers = { nullptr, col.offsets.data(), col.bytes.empty() ? &empty_bytes : col.bytes.data() };
+						child.n_buffers = 3;
+					}
+					internal::Share_Arrow(child, holder);
+					holder->child_pointers[i] = &child;
+				}
+
+				*out = ArrowArray{};
+				out->length = static_cast<int64_t>(batch.rows);
+				out->n_buffers = 1;
+				out->buffers = holder->root_buffers.data();
+				out->n_children = static_cast<int64_t>(count);
+				out->children = holder->child_pointers.data();
+				internal::Share_Arrow(*out, holder);
+
+				return batch.rows;
+			}
+
+			/**
+			 * Retrieves the count of observations (rows) in the file; the count is determined from the size of the file, so it is not known
+			 * e.g. for streamed sources. Trailing blank rows, which fit entirely to the padding of the last 80-byte record, are not counted
+			 * Unless the count is stated by the header, the rows not read yet are searched for the header of the next member on the first call
+			 * (as well as by Seek_Row and Parallel_For_Each_Batch), so the rows of the first member of a library are not counted beyond it
+			 */
+			std::optional<size_t> Row_Count() const {
+				Resolve_Row_Count();
+				return mRow_Count;
+			}
+
+			/**
+			 * Moves to the row of a given index (zero-based), so the subsequent read retrieves this row
+			 * Returns true on success, false if the row does not exist or the source does not support seeking
+			 */
+			bool Seek_Row(size_t row) {
+				Resolve_Row_Count();
+				if (!mSource || (mRow_Count.has_value() && row > *mRow_Count)) {
+					return false;
+				}
+
+				if (!mSource->Seek(mData_Offset + row * mRecord_Len)) {
+					return false;
+				}
+
+				mNext_Row = row;
+				return true;
+			}
+
+			/**
+			 * Reads the row of a given index (zero-based); accepts the same target parameters as Read_Next, and subsequent reads continue with the next row
+			 * If a filter is set (see Set_Filter), the first row meeting it at or after the given index is read
+			 * Returns true on success, false if the row does not exist or the source does not support seeking
+			 */
+			template<typename... Args>
+			bool Read_Row(size_t row, Args&... args) {
+				return Seek_Row(row) && Read_Next(args...);
+			}
+
+			/**
+			 * Scans all the observations in parallel - the observation section is split to blocks of rows_per_batch rows, which are read and decoded
+			 * by a given count of threads (0 for the hardware concurrency), each thread using its own source and batch. The function is called
+			 * as fn(const Column_Batch& batch, size_t first_row) concurrently from the worker threads, in no particular order, so it must be thread-safe.
+			 * The scan is independent of the sequential reads, which are not affected by it. If the function throws, the scan is stopped and
+			 * the exception is rethrown to the caller
+			 * Returns true on success, false if the source does not support parallel access (its size is unknown, or it cannot be duplicated)
+			 */
+			template<typename TFunc>
+			bool Parallel_For_Each_Batch(size_t threads, size_t rows_per_batch, TFunc&& fn) const {
+
+				if (!mSource || mRecord_Len == 0 || rows_per_batch == 0) {
+					return false;
+				}
+				Resolve_Row_Count();
+				if (!mRow_Count.has_value()) {
+					return false;
+				}
+
+				const size_t total_rows = *mRow_Count;
+				const size_t block_count = (total_rows + rows_per_batch - 1) / rows_per_batch;
+
+				if (threads == 0) {
+					threads = std::max(1u, std::thread::hardware_concurrency());
+				}
+				threads = std::min(threads, block_count);
+
+				// every worker needs its own source, so the positions do not interfere
+				std::vector<std::unique_ptr<Input_Source>> sources;
+				for (size_t i = 0; i < threads; i++) {
+					auto source = mSource->Clone();
+					if (!source) {
+						return false;
+					}
+					sources.push_back(std::move(source));
+				}
+
+				std::atomic<size_t> next_block = 0;
+				std::atomic<bool> failed = false;
+				std::exception_ptr error;
+
+				// statistics are collected separately by the workers, and summed up when they are finished
+				std::vector<File_Stats> worker_stats(threads);
+
+				auto worker = [&](Input_Source& source, [[maybe_unused]] File_Stats& stats) {
+					std::vector<std::byte> buffer;
+					Column_Batch batch;
+
+					try {
+						for (size_t block = next_block++; block < block_count && !failed; block = next_block++) {
+							const size_t first_row = block * rows_per_batch;
+							const size_t row_count = std::min(rows_per_batch, total_rows - first_row);
+
+							if (!source.Seek(mData_Offset + first_row * mRecord_Len)) {
+								throw std::runtime_error{ "Cannot seek to the requested data" };
+							}
+
+							XPTLIB_STATS(const auto io_start = internal::Stats_Clock::now());
+							const auto data = source.Fetch(row_count * mRecord_Len, buffer);
+							XPTLIB_STATS(stats.io_ns += internal::Elapsed_Ns(io_start); stats.read_calls++; stats.bytes_read += data.size());
+
+							Decode_Batch(data, data.size() / mRecord_Len, batch, stats);
+
+							fn(static_cast<const Column_Batch&>(batch), first_row);
+						}
+					}
+					catch (...) {
+						// only the first error is kept
+						if (!failed.exchange(true)) {
+							error = std::current_exception();
+						}
+					}
+				};
+
+				std::vector<std::thread> workers;
+				for (size_t i = 1; i < threads; i++) {
+					workers.emplace_back(worker, std::ref(*sources[i]), std::ref(worker_stats[i]));
+				}
+				if (threads > 0) {
+					worker(*sources[0], worker_stats[0]);
+				}
+				for (auto& thr : workers) {
+					thr.join();
+				}
+
+				XPTLIB_STATS(for (const auto& stats : worker_stats) { mStats += stats; });
+
+				if (error) {
+					std::rethrow_exception(error);
+				}
+
+				return true;
+			}
+
+			/**
+			 * Computes the summary statistics (counts, minimum, maximum, sum, mean, variance and optional histograms) of given numeric variables
+			 * over all the rows meeting the filter, in a single pass through the batch path, without materializing the rows. With more than one thread
+			 * (0 for the hardware concurrency), the blocks of rows are aggregated in parallel (see Parallel_For_Each_Batch) and the partial statistics
+			 * are merged; if the source does not support it, or with a single thread, the rows are aggregated sequentially, from the first row for
+			 * seekable sources (from the current row otherwise). The rows are read in batches of rows_per_batch rows (0 for the default size)
+			 * The column selection is not affected
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Variable if any of the variables does not exist, NStatus::Type_Mismatch
+			 * if any of them is not numeric, or NStatus::Invalid_Variable if the histogram range of any of them is invalid (see Aggregate_Spec);
+			 * the result is left empty on failure
+			 */
+			NStatus Aggregate(const std::vector<Aggregate_Spec>& specs, std::vector<Column_Stats>& result, size_t threads = 1, size_t rows_per_batch = 65536) {
+
+				result.clear();
+				if (rows_per_batch == 0) {
+					rows_per_batch = 65536;
+				}
+
+				// the bins must have a finite, positive width
+				for (const auto& spec : specs) {
+					if (spec.histogram_bins != 0) {
+						const double width = (spec.histogram_max - spec.histogram_min) / static_cast<double>(spec.histogram_bins);
+						if (!(spec.histogram_max > spec.histogram_min) || !std::isfinite(width) || width <= 0.0) {
+							return NStatus::Invalid_Variable;
+						}
+					}
+				}
+
+				// the aggregated variables are selected just for the scan
+				struct Selection_Guard {
+					std::vector<size_t>& target;
+					std::vector<size_t> saved;
+					~Selection_Guard() {
+						target = std::move(saved);
+					}
+				} guard{ mSelection, mSelection };
+
+				std::vector<std::string_view> names;
+				for (const auto& spec : specs) {
+					names.push_back(spec.variable);
+				}
+				if (const auto status = Select(names); status != NStatus::Ok) {
+					return status;
+				}
+
+				// empty statistics, with the histograms prepared
+				std::vector<Column_Stats> initial(specs.size());
+				for (size_t i = 0; i < specs.size(); i++) {
+					if (mVariables[mSelection[i]].type != NVar_Type::Numeric) {
+						return NStatus::Type_Mismatch;
+					}
+					initial[i].variable = mSelection[i];
+					initial[i].histogram_min = specs[i].histogram_min;
+					initial[i].histogram_max = specs[i].histogram_max;
+					initial[i].histogram.assign(specs[i].histogram_bins, 0);
+				}
+
+				// adds the rows of the batch meeting the filter to the statistics
+				auto accumulate = [](const Column_Batch& batch, std::vector<Column_Stats>& stats, std::vector<double>& selected) {
+					for (size_t i = 0; i < stats.size(); i++) {
+						const auto& numbers = batch.columns[i].numbers;
+						if (!batch.filtered) {
+							stats[i].Add(numbers.data(), batch.rows);
+							continue;
+						}
+
+						selected.resize(batch.selection.size());
+						for (size_t j = 0; j < batch.selection.size(); j++) {
+							selected[j] = numbers[batch.selection[j]];
+						}
+						stats[i].Add(selected.data(), selected.size());
+					}
+				};
+
+				result = initial;
+
+				if (threads != 1) {
+					std::mutex result_mutex;
+					const bool parallel = Parallel_For_Each_Batch(threads, rows_per_batch, [&](const Column_Batch& batch, size_t) {
+						// the block is aggregated separately, so the lock is held just for the merge
+						std::vector<Column_Stats> partial = initial;
+						std::vector<double> selected;
+						accumulate(batch, partial, selected);
+
+						std::lock_guard<std::mutex> lck(result_mutex);
+						for (size_t i = 0; i < partial.size(); i++) {
+							result[i].Merge(partial[i]);
+						}
+					});
+					if (parallel) {
+						return NStatus::Ok;
+					}
+				}
+
+				if (mNext_Row != 0) {
+					Seek_Row(0);
+				}
+
+				Column_Batch batch;
+				std::vector<double> selected;
+				while (Read_Batch(rows_per_batch, batch) > 0) {
+					accumulate(batch, result, selected);
+				}
+
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Reads next row meeting the filter in its raw form, as stored in the file (regardless of the column selection)
+			 * The row points either to the internal row buffer, or directly to the source memory, and is valid only until the next read from this file
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file)
+			 */
+			bool Read_Next_Raw(std::span<const std::byte>& row) {
+				return Fetch_Matching_Row(row);
+			}
+
+			/**
+			 * Selects the columns retrieved by all subsequent reads; the values are then retrieved in the order given, and other columns are not decoded at all
+			 * Returns NStatus::Ok on success, or NStatus::No_Such_Variable if any of the names does not match any variable (the selection is then left unchanged)
+			 */
+			template<typename TNames>
+			NStatus Select(const TNames& names) {
+
+				std::vector<size_t> selection;
+				for (const auto& name : names) {
+					auto itr = std::find_if(mVariables.begin(), mVariables.end(), [&name](const Variable_Record& var) {
+						return var.name == name;
+					});
+					if (itr == mVariables.end()) {
+						return NStatus::No_Such_Variable;
+					}
+					selection.push_back(static_cast<size_t>(std::distance(mVariables.begin(), itr)));
+				}
+
+				mSelection = std::move(selection);
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Selects the columns retrieved by all subsequent reads (see above)
+			 */
+			NStatus Select(std::initializer_list<std::string_view> names) {
+				return Select<std::initializer_list<std::string_view>>(names);
+			}
+
+			/**
+			 * Sets whether string columns of batches are decoded lazily; the string fields are then left in the data read from the file,
+			 * and are trimmed only when accessed by Column_Batch::Column::String. Lazy values are valid only until the next read from this file
+			 * (or until the end of the callback of Parallel_For_Each_Batch), unless the batch is materialized using Column_Batch::Materialize
+			 */
+			void Set_Lazy_Strings(bool lazy) {
+				mLazy_Strings = lazy;
+			}
+
+			/**
+			 * Sets the string variables, which are dictionary-encoded by the batch reads: their values are interned to a per-column dictionary
+			 * (see Column_Batch::Column::dictionary), and the columns contain just the codes of the values. This saves both the memory
+			 * and the time of grouping for low-cardinality columns. The encoding of other variables is not affected
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Variable if any of the variables does not exist, or NStatus::Type_Mismatch
+			 * if any of them is not a string variable (the setting is then left unchanged)
+			 */
+			template<typename TNames>
+			NStatus Set_Dictionary_Encoding(const TNames& names) {
+
+				std::vector<bool> encoded(mVariables.size(), false);
+				for (const auto& name : names) {
+					auto itr = std::find_if(mVariables.begin(), mVariables.end(), [&name](const Variable_Record& var) {
+						return var.name == name;
+					});
+					if (itr == mVariables.end()) {
+						return NStatus::No_Such_Variable;
+					}
+					if (itr->type != NVar_Type::String) {
+						return NStatus::Type_Mismatch;
+					}
+					encoded[static_cast<size_t>(std::distance(mVariables.begin(), itr))] = true;
+				}
+
+				mDictionary_Encoded = std::move(encoded);
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Sets the string variables, which are dictionary-encoded by the batch reads (see above)
+			 */
+			NStatus Set_Dictionary_Encoding(std::initializer_list<std::string_view> names) {
+				return Set_Dictionary_Encoding<std::initializer_list<std::string_view>>(names);
+			}
+
+			/**
+			 * Sets the row filter; all subsequent reads then retrieve only the rows meeting all the given conditions. The conditions are evaluated
+			 * directly on the raw rows, before anything is decoded - strings are compared to the blank-padded fields, and numbers are converted
+			 * just for the comparison. Missing numeric values meet only the Not_Equal conditions. The batch reads retrieve all the rows read,
+			 * along with the selection vector of the rows meeting the filter (see Column_Batch::selection); only the selected strings are copied
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Variable if any of the variables does not exist, or NStatus::Type_Mismatch
+			 * if any of the values does not match the type of the variable (the filter is then left unchanged)
+			 */
+			NStatus Set_Filter(const std::vector<Condition>& conditions) {
+
+				std::vector<internal::Row_Condition> filter;
+				for (const auto& cond : conditions) {
+
+					auto itr = std::find_if(mVariables.begin(), mVariables.end(), [&cond](const Variable_Record& var) {
+						return var.name == cond.variable;
+					});
+					if (itr == mVariables.end()) {
+						return NStatus::No_Such_Variable;
+					}
+
+					internal::Row_Condition& row_cond = filter.emplace_back();
+					row_cond.variable = static_cast<size_t>(std::distance(mVariables.begin(), itr));
+					row_cond.position = itr->position;
+					row_cond.length = itr->length;
+					row_cond.decode = itr->decode;
+					row_cond.op = cond.op;
+
+					if (itr->type == NVar_Type::Numeric) {
+						if (cond.op == NCompare::Starts_With || !std::holds_alternative<double>(cond.value)) {
+							return NStatus::Type_Mismatch;
+						}
+						row_cond.number = std::get<double>(cond.value);
+					}
+					else {
+						if (!std::holds_alternative<std::string>(cond.value)) {
+							return NStatus::Type_Mismatch;
+						}
+						row_cond.text = std::get<std::string>(cond.value);
+
+						// the field may be compared directly, if the value is not longer than the field, and does not end with a blank
+						// (for Starts_With, the empty value matches everything, so it is compared the slow way, as well)
+						row_cond.raw_compare = !row_cond.text.empty() && row_cond.text.size() <= row_cond.length
+							&& !internal::Is_Trailing_Blank(row_cond.text.back());
+					}
+				}
+
+				mFilter = std::move(filter);
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Retrieves the statistics of the reads from this file (since it was opened, or since Reset_Stats)
+			 * The statistics are collected only if XPTLIB_ENABLE_STATS is defined prior to including this header; all of them are zero otherwise
+			 */
+			const File_Stats& Get_Stats() const {
+				return mStats;
+			}
+
+			/**
+			 * Resets the statistics of the reads
+			 */
+			void Reset_Stats() {
+				mStats = File_Stats{};
+			}
+
+			/**
+			 * Removes the row filter, so all rows are retrieved by subsequent reads
+			 */
+			void Clear_Filter() {
+				mFilter.clear();
+			}
+
+			/**
+			 * Resets the selection, so all columns are retrieved by subsequent reads, in the order of the variable vector
+			 */
+			void Select_All() {
+				mSelection.resize(mVariables.size());
+				for (size_t i = 0; i < mSelection.size(); i++) {
+					mSelection[i] = i;
+				}
+			}
+
+			/**
+			 * Retrieves the indices (to the variable vector) of currently selected columns
+			 */
+			const std::vector<size_t>& Get_Selection() const {
+				return mSelection;
+			}
+
+			/**
+			 * Retrieves a vector of variables
+			 */
+			const std::vector<Variable_Record>& Get_Variable_Vector() const {
+				return mVariables;
+			}
+	};
+
+	/**
+	 * A class reading a set of files with the same variables (e.g., many small files of a study) as a single stream of batches
+	 * The files are opened and their headers are read by a pool of threads ahead of the reads, so the per-file costs overlap
+	 * with the decoding of the preceding files. Every file must have the same variables (names and types, in the same order)
+	 * as the first one; other files (and files which cannot be read) are skipped, and their status is kept (see Get_File_Status)
+	 */
+	class File_Set {
+
+		private:
+			// file opened ahead of the reads
+			struct Slot {
+				std::unique_ptr<File> file;
+				NStatus status = NStatus::Ok;
+				bool ready = false;
+			};
+
+			std::vector<std::filesystem::path> mPaths;
+			std::vector<Slot> mSlots;
+
+			// variables of the first file, which all others must match
+			std::vector<Variable_Record> mVariables;
+			std::vector<std::string> mSelected_Names;
+
+			// pool of threads opening the files, at most mLookahead files past the file being read
+			std::vector<std::thread> mWorkers;
+			std::mutex mMutex;
+			std::condition_variable mChanged;
+			size_t mNext_Open = 0;
+			size_t mNext_Read = 0;
+			size_t mLookahead = 0;
+			bool mStopped = false;
+
+			// file being read, and its index
+			std::unique_ptr<File> mCurrent;
+			size_t mCurrent_Index = 0;
+
+			// batch of the current file, appended to the batch being read
+			Column_Batch mFile_Batch;
+
+			// is the file compatible with the first one?
+			bool Is_Compatible(const File& file) const {
+				const auto& variables = file.Get_Variable_Vector();
+				return std::equal(variables.begin(), variables.end(), mVariables.begin(), mVariables.end(), [](const Variable_Record& a, const Variable_Record& b) {
+					return a.name == b.name && a.type == b.type;
+				});
+			}
+
+			void Open_Worker() {
+				std::unique_lock lock(mMutex);
+				while (true) {
+					mChanged.wait(lock, [this]() { return mStopped || mNext_Open >= mPaths.size() || mNext_Open < mNext_Read + mLookahead; });
+					if (mStopped || mNext_Open >= mPaths.size()) {
+						return;
+					}
+
+					const size_t index = mNext_Open++;
+					lock.unlock();
+
+					auto file = std::make_unique<File>();
+					if (!file->Open_Mapped(mPaths[index])) {
+						file->Open(mPaths[index]);
+					}
+					NStatus status = file->Read_Headers();
+
+					lock.lock();
+					// the variables of the first file are kept at the time it is taken by the reader
+					if (status == NStatus::Ok && index != 0 && !mVariables.empty() && !Is_Compatible(*file)) {
+						status = NStatus::Type_Mismatch;
+					}
+					mSlots[index].file = status == NStatus::Ok ? std::move(file) : nullptr;
+					mSlots[index].status = status;
+					mSlots[index].ready = true;
+					mChanged.notify_all();
+				}
+			}
+
+			// takes the next readable file from the pool; returns false if there are no more files
+			bool Take_Next_File() {
+				std::unique_lock lock(mMutex);
+				while (mNext_Read < mPaths.size()) {
+					const size_t index = mNext_Read;
+					mChanged.wait(lock, [&]() { return mSlots[index].ready; });
+
+					auto file = std::move(mSlots[index].file);
+					mNext_Read++;
+					mChanged.notify_all();
+
+					// files opened before the variables of the first one were known are checked now
+					if (file && index != 0 && !Is_Compatible(*file)) {
+						mSlots[index].status = NStatus::Type_Mismatch;
+						file.reset();
+					}
+					if (file && !mSelected_Names.empty() && file->Select(mSelected_Names) != NStatus::Ok) {
+						mSlots[index].status = NStatus::No_Such_Variable;
+						file.reset();
+					}
+
+					if (file) {
+						mCurrent = std::move(file);
+						mCurrent_Index = index;
+						return true;
+					}
+				}
+				return false;
+			}
+
+			void Stop() {
+				{
+					std::lock_guard lock(mMutex);
+					mStopped = true;
+				}
+				mChanged.notify_all();
+				for (auto& thr : mWorkers) {
+					thr.join();
+				}
+				mWorkers.clear();
+			}
+
+		public:
+			File_Set() = default;
+			File_Set(const File_Set&) = delete;
+			File_Set& operator=(const File_Set&) = delete;
+
+			~File_Set() {
+				Stop();
+			}
+
+			/**
+			 * Starts opening the files of given paths using a given count of threads (0 for the hardware concurrency), and reads the headers
+			 * of the first file, which define the variables of the set. At most lookahead files (0 for twice the count of threads) are kept
+			 * opened ahead of the file being read
+			 * Returns the status of reading the headers of the first file (NStatus::No_Library_Header if there are no paths)
+			 */
+			NStatus Open(std::vector<std::filesystem::path> paths, size_t threads = 0, size_t lookahead = 0) {
+
+				Stop();
+
+				if (threads == 0) {
+					threads = std::max(1u, std::thread::hardware_concurrency());
+				}
+
+				mPaths = std::move(paths);
+				mSlots = std::vector<Slot>(mPaths.size());
+				mVariables.clear();
+				mSelected_Names.clear();
+				mNext_Open = 0;
+				mNext_Read = 0;
+				mLookahead = lookahead != 0 ? lookahead : 2 * threads;
+				mStopped = false;
+				mCurrent.reset();
+
+				if (mPaths.empty()) {
+					return NStatus::No_Library_Header;
+				}
+
+				threads = std::min(threads, mPaths.size());
+				for (size_t i = 0; i < threads; i++) {
+					mWorkers.emplace_back(&File_Set::Open_Worker, this);
+				}
+
+				std::unique_lock lock(mMutex);
+				mChanged.wait(lock, [this]() { return mSlots[0].ready; });
+				if (mSlots[0].status == NStatus::Ok) {
+					mVariables = mSlots[0].file->Get_Variable_Vector();
+				}
+				return mSlots[0].status;
+			}
+
+			/**
+			 * Selects the columns retrieved by the subsequent reads, for all files of the set (see File::Select)
+			 * Returns NStatus::Ok on success, or NStatus::No_Such_Variable if any of the variables does not exist (the selection is then left unchanged)
+			 */
+			template<typename TNames>
+			NStatus Select(const TNames& names) {
+
+				std::vector<std::string> selected;
+				for (const auto& name : names) {
+					auto itr = std::find_if(mVariables.begin(), mVariables.end(), [&name](const Variable_Record& var) {
+						return var.name == name;
+					});
+					if (itr == mVariables.end()) {
+						return NStatus::No_Such_Variable;
+					}
+					selected.emplace_back(itr->name);
+				}
+
+				std::lock_guard lock(mMutex);
+				mSelected_Names = std::move(selected);
+				if (mCurrent) {
+					mCurrent->Select(mSelected_Names);
+				}
+				return NStatus::Ok;
+			}
+
+			/**
+			 * Selects the columns retrieved by the subsequent reads (see above)
+			 */
+			NStatus Select(std::initializer_list<std::string_view> names) {
+				return Select<std::initializer_list<std::string_view>>(names);
+			}
+
+			/**
+			 * Reads up to max_rows next rows of the set into the columnar batch (see File::Read_Batch); the batch may contain rows of multiple files,
+			 * and sources is filled with the index (to the paths given to Open) of the file of each row
+			 * Returns the count of rows read, zero when all the files were read
+			 */
+			size_t Read_Batch(size_t max_rows, Column_Batch& batch, std::vector<uint32_t>& sources) {
+
+				batch.rows = 0;
+				sources.clear();
+
+				while (batch.rows < max_rows) {
+					if (!mCurrent && !Take_Next_File()) {
+						break;
+					}
+
+					// the first rows are read directly to the batch; rows of the subsequent files are appended
+					const size_t wanted = max_rows - batch.rows;
+					const size_t first = batch.rows;
+					if (batch.rows == 0) {
+						mCurrent->Read_Batch(wanted, batch);
+					}
+					else if (mCurrent->Read_Batch(wanted, mFile_Batch) > 0) {
+						batch.Append(mFile_Batch);
+					}
+
+					if (batch.rows == first) {
+						mCurrent.reset();
+						continue;
+					}
+					sources.resize(batch.rows, static_cast<uint32_t>(mCurrent_Index));
+				}
+
+				return batch.rows;
+			}
+
+			/**
+			 * Retrieves the status of the file of a given index: NStatus::Ok for a file which was (or will be) read, NStatus::Type_Mismatch
+			 * for a file whose variables do not match the first file, or the status of reading its headers
+			 * The status is known only after the reads reached the file
+			 */
+			NStatus Get_File_Status(size_t index) const {
+				return mSlots[index].status;
+			}
+
+			/**
+			 * Retrieves the paths of the files of the set
+			 */
+			const std::vector<std::filesystem::path>& Get_Paths() const {
+				return mPaths;
+			}
+
+			/**
+			 * Retrieves a vector of variables (of the first file)
+			 */
 			const std::vector<Variable_Record>& Get_Variable_Vector() const {
 				return mVariables;
 			}
 	};
 
+	/**
+	 * Binding of a column (given by its name) to a member of the user row structure; see Row_Binding
+	 */
+	template<typename TStruct, typename TMember>
+	struct Field {
+		std::string_view name;
+		TMember TStruct::* member;
+	};
+
+	template<typename TStruct, typename TMember>
+	Field(std::string_view, TMember TStruct::*) -> Field<TStruct, TMember>;
+
+	/**
+	 * Binding of a user row structure to the columns of a file. The types of the members determine the conversion at compile time:
+	 *  - floating-point members are filled from numeric columns (missing values are NaNs)
+	 *  - integral members (except bool) are filled from numeric columns truncated toward zero; missing values and values out of range
+	 *    of the type are stored as the lowest value of the type (std::numeric_limits<T>::min())
+	 *  - std::optional members of these types are filled the same way, but std::nullopt is stored instead of missing values and values out of range
+	 *  - std::string and std::string_view members are filled from string columns (the views point to the row and are valid only until the next read)
+	 * The binding is validated against the variables of the file just once, so the rows are then decoded without any type checks, e.g.:
+	 *   xpt::Row_Binding binding{ xpt::Field{ "USUBJID", &Row::subject }, xpt::Field{ "AVAL", &Row::value } };
+	 */
+	template<typename TStruct, typename... TMembers>
+	class Row_Binding {
+
+		private:
+			template<typename TMember>
+			static constexpr bool Is_Integral_Member = std::is_integral_v<TMember> && !std::is_same_v<TMember, bool>;
+
+			template<typename TMember>
+			struct Optional_Member : std::false_type {
+			};
+
+			template<typename TField_Value>
+			struct Optional_Member<std::optional<TField_Value>> : std::bool_constant<std::is_floating_point_v<TField_Value> || Is_Integral_Member<TField_Value>> {
+			};
+
+			template<typename TMember>
+			static constexpr bool Is_Numeric_Member = std::is_floating_point_v<TMember> || Is_Integral_Member<TMember> || Optional_Member<TMember>::value;
+
+			template<typename TMember>
+			static constexpr bool Is_String_Member = std::is_same_v<TMember, std::string> || std::is_same_v<TMember, std::string_view>;
+
+			static_assert(((Is_Numeric_Member<TMembers> || Is_String_Member<TMembers>) && ...),
+				"Row_Binding members must be of floating-point, integral (except bool), std::optional of these, std::string or std::string_view type");
+
+			// can the value be converted to the integral type? (missing values, i.e. NaNs, cannot); fractions are truncated toward zero
+			template<typename TField_Value>
+			static bool Is_Representable(double value) {
+				constexpr double lowest = static_cast<double>(std::numeric_limits<TField_Value>::min());
+				constexpr double highest = static_cast<double>(std::numeric_limits<TField_Value>::max());
+				return value > lowest - 1.0 && value < highest + 1.0;
+			}
+
+			// converts the numeric value to the type of the member: missing values and values out of range of integral types are stored
+			// as std::nullopt to optional members, and as the lowest value of the type to integral members
+			template<typename TMember>
+			static TMember Convert_Number(double value) {
+				if constexpr (std::is_floating_point_v<TMember>) {
+					return static_cast<TMember>(value);
+				}
+				else if constexpr (Is_Integral_Member<TMember>) {
+					return Is_Representable<TMember>(value) ? static_cast<TMember>(value) : std::numeric_limits<TMember>::min();
+				}
+				else {
+					using TField_Value = typename TMember::value_type;
+					if constexpr (std::is_floating_point_v<TField_Value>) {
+						return std::isnan(value) ? TMember{} : TMember{ static_cast<TField_Value>(value) };
+					}
+					else {
+						return Is_Representable<TField_Value>(value) ? TMember{ static_cast<TField_Value>(value) } : TMember{};
+					}
+				}
+			}
+
+			// bound fields
+			std::tuple<Field<TStruct, TMembers>...> mFields;
+
+			// resolved offsets of columns in the row and their lengths
+			std::array<size_t, sizeof...(TMembers)> mPositions{};
+			std::array<size_t, sizeof...(TMembers)> mLengths{};
+
+			// file the binding has been bound to
+			File* mFile = nullptr;
+
+			// validates a single field against the variables
+			template<size_t I>
+			NStatus Resolve_Field(const File& file) {
+
+				using TMember = std::tuple_element_t<I, std::tuple<TMembers...>>;
+
+				const auto& field = std::get<I>(mFields);
+				const auto& vars = file.Get_Variable_Vector();
+
+				auto itr = std::find_if(vars.begin(), vars.end(), [&field](const auto& var) {
+					return var.name == field.name;
+				});
+				if (itr == vars.end()) {
+					return NStatus::No_Such_Variable;
+				}
+
+				const auto expected = Is_Numeric_Member<TMember> ? NVar_Type::Numeric : NVar_Type::String;
+				if (itr->type != expected) {
+					return NStatus::Type_Mismatch;
+				}
+
+				// the fields are decoded without any checks, so they must lie within the row, and the numbers must fit to a double
+				size_t record_length = 0;
+				for (const auto& var : vars) {
+					record_length += var.length;
+				}
+				if (itr->length == 0 || itr->position + itr->length > record_length || (Is_Numeric_Member<TMember> && (itr->length < 2 || itr->length > 8))) {
+					return NStatus::Invalid_Variable;
+				}
+
+				mPositions[I] = itr->position;
+				mLengths[I] = itr->length;
+				return NStatus::Ok;
+			}
+
+			template<size_t... I>
+			NStatus Resolve_Fields(const File& file, std::index_sequence<I...>) {
+				NStatus result = NStatus::Ok;
+				// stop on the first failure
+				static_cast<void>((((result = Resolve_Field<I>(file)) == NStatus::Ok) && ...));
+				return result;
+			}
+
+			// decodes a single field; the conversion is selected at compile time
+			template<size_t I>
+			void Decode_Field(std::span<const std::byte> row, TStruct& target) const {
+
+				using TMember = std::tuple_element_t<I, std::tuple<TMembers...>>;
+
+				auto& dst = target.*(std::get<I>(mFields).member);
+
+				if constexpr (Is_Numeric_Member<TMember>) {
+					dst = Convert_Number<TMember>(internal::IbmToIEEE(internal::Get_Number_From_Buffer(row, mPositions[I], mLengths[I])));
+				}
+				else if constexpr (std::is_same_v<TMember, std::string_view>) {
+					dst = internal::Get_View_From_Buffer(row, mPositions[I], mLengths[I]);
+				}
+				else {
+					dst.assign(internal::Get_View_From_Buffer(row, mPositions[I], mLengths[I]));
+				}
+			}
+
+			template<size_t... I>
+			void Decode_Fields(std::span<const std::byte> row, TStruct& target, std::index_sequence<I...>) const {
+				(Decode_Field<I>(row, target), ...);
+			}
+
+		public:
+			Row_Binding(Field<TStruct, TMembers>... fields) : mFields(fields...) {
+			}
+
+			/**
+			 * Binds the structure to the file; the file headers must be read prior to this call
+			 * Returns NStatus::Ok on success, NStatus::No_Such_Variable if any column does not exist, NStatus::Type_Mismatch if a column
+			 * type does not match the member type, or NStatus::Invalid_Variable if the length or position of a column is not valid
+			 */
+			NStatus Bind(File& file) {
+				mFile = nullptr;
+
+				const auto result = Resolve_Fields(file, std::index_sequence_for<TMembers...>{});
+				if (result == NStatus::Ok) {
+					mFile = &file;
+				}
+
+				return result;
+			}
+
+			/**
+			 * Decodes the given raw row (see File::Read_Next_Raw) to the target structure
+			 */
+			void Decode(std::span<const std::byte> row, TStruct& target) const {
+				Decode_Fields(row, target, std::index_sequence_for<TMembers...>{});
+			}
+
+			/**
+			 * Reads next row of the bound file to the target structure
+			 * Returns true on success, false when an EOF occurred (there are no more records in the file), or the binding is not bound
+			 */
+			bool Read_Next(TStruct& target) {
+				std::span<const std::byte> row;
+				if (!mFile || !mFile->Read_Next_Raw(row)) {
+					return false;
+				}
+
+				Decode(row, target);
+				return true;
+			}
+	};
+
+	/**
+	 * Definition of a variable (column) to be written by xpt::Writer
+	 */
+	struct Variable_Definition {
+		std::string name;											// up to 8 characters
+		std::string label;											// up to 40 characters
+		NVar_Type type = NVar_Type::Numeric;
+		size_t length = 8;											// 3 to 8 for numeric variables (shorter values are truncated), 1 to 200 for string variables
+	};
+
+	/**
+	 * A class representing XPT (v5) file writer
+	 * All the data are streamed through a large output buffer; numeric values are encoded to IBM format in bulk when writing batches
+	 */
+	class Writer {
+
+		private:
+			// output file stream
+			std::ofstream mFile;
+
+			// output buffer and the count of bytes used
+			std::vector<std::byte> mBuffer;
+			size_t mBuffer_Used = 0;
+
+			// total count of bytes written to the file (including the buffer contents)
+			size_t mWritten = 0;
+
+			// variables being written, their offsets in the row and the row length
+			std::vector<Variable_Definition> mVariables;
+			std::vector<size_t> mPositions;
+			size_t mRecord_Len = 0;
+
+			bool mHeaders_Written = false;
+			bool mFailed = false;
+
+		private:
+			// writes the buffer contents to the file
+			bool Flush() {
+				if (mBuffer_Used > 0) {
+					mFile.write(reinterpret_cast<const char*>(mBuffer.data()), static_cast<std::streamsize>(mBuffer_Used));
+					mBuffer_Used = 0;
+					if (!mFile) {
+						mFailed = true;
+					}
+				}
+
+				return !mFailed;
+			}
+
+			// reserves a given count of bytes in the output buffer and returns a pointer to them (the buffer is flushed, if needed)
+			std::byte* Reserve(size_t count) {
+				if (mBuffer_Used + count > mBuffer.size()) {
+					Flush();
+					if (count > mBuffer.size()) {
+						mBuffer.resize(count);
+					}
+				}
+
+				std::byte* dst = mBuffer.data() + mBuffer_Used;
+				mBuffer_Used += count;
+				mWritten += count;
+				return dst;
+			}
+
+			// writes the given data to the output buffer
+			void Put(const void* data, size_t count) {
+				std::memcpy(Reserve(count), data, count);
+			}
+
+			// writes a given structure, padded with blanks to 80 bytes
+			template<typename T>
+			void Put_Record(const T& record) {
+				static_assert(sizeof(T) <= 80);
+				std::byte* dst = Reserve(80);
+				std::memcpy(dst, &record, sizeof(T));
+				std::fill(dst + sizeof(T), dst + 80, std::byte{ ' ' });
+			}
+
+			// pads the output with blanks to the 80-byte boundary
+			void Put_Padding() {
+				const size_t rest = mWritten % 80;
+				if (rest != 0) {
+					const size_t count = 80 - rest;
+					std::fill_n(Reserve(count), count, std::byte{ ' ' });
+				}
+			}
+
+			// copies the string to a fixed-length character field, padded with blanks (the string is truncated, if necessary)
+			static void Put_String(std::byte* dst, std::string_view str, size_t length) {
+				const size_t count = std::min(str.size(), length);
+				if (count != 0) {
+					std::memcpy(dst, str.data(), count);
+				}
+				std::fill(dst + count, dst + length, std::byte{ ' ' });
+			}
+
+			template<size_t N>
+			static void Put_String(char (&dst)[N], std::string_view str) {
+				Put_String(reinterpret_cast<std::byte*>(dst), str, N);
+			}
+
+			// writes the header record of a given name, with given numeric fields (30 characters)
+			void Put_Header(std::string_view name, std::string_view nums = "000000000000000000000000000000") {
+				internal::Data_Header_Generic hdr;
+				Put_String(hdr.hdrrec, "HEADER RECORD");
+				Put_String(hdr.stars, "*******");
+				Put_String(hdr.namedesc, name);
+				Put_String(hdr.exclamations, "!!!!!!!");
+				std::memcpy(hdr.num1, nums.data(), std::min<size_t>(nums.size(), 30));
+				Put_Record(hdr);
+			}
+
+			// fills the date and time record with current (UTC) date and time
+			static void Fill_Date_Time(internal::Date_Time_Record& record) {
+				static constexpr const char* Months[] = { "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC" };
+
+				const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+				const auto days = std::chrono::floor<std::chrono::days>(now);
+				const std::chrono::year_month_day ymd{ days };
+				const std::chrono::hh_mm_ss hms{ now - days };
+
+				char buf[32];
+				std::snprintf(buf, sizeof(buf), "%02u%s%02d:%02d:%02d:%02d", static_cast<unsigned>(ymd.day()), Months[static_cast<unsigned>(ymd.month()) - 1],
+					static_cast<int>(ymd.year()) % 100, static_cast<int>(hms.hours().count()), static_cast<int>(hms.minutes().count()), static_cast<int>(hms.seconds().count()));
+				std::memcpy(&record, buf, sizeof(record));
+			}
+
+			// encodes a single value of a given variable to the row; the value is converted, if it does not match the variable type
+			template<typename T>
+			void Encode_Value(std::byte* row, size_t idx, const T& value) const {
+
+				const auto& var = mVariables[idx];
+				std::byte* dst = row + mPositions[idx];
+
+				if constexpr (std::is_arithmetic_v<T>) {
+					if (var.type == NVar_Type::Numeric) {
+						const uint64_t raw = internal::IEEEToIbm(static_cast<double>(value));
+						std::memcpy(dst, &raw, var.length);
+					}
+					else {
+						Put_String(dst, std::to_string(value), var.length);
+					}
+				}
+				else {
+					const std::string_view str{ value };
+					if (var.type == NVar_Type::String) {
+						Put_String(dst, str, var.length);
+					}
+					else {
+						const uint64_t raw = internal::IEEEToIbm(std::stod(std::string{ str }));
+						std::memcpy(dst, &raw, var.length);
+					}
+				}
+			}
+
+			template<typename TVariant>
+			bool Write_Variant_Row(const std::vector<TVariant>& values) {
+				if (!mHeaders_Written || values.size() != mVariables.size()) {
+					return false;
+				}
+
+				std::byte* row = Reserve(mRecord_Len);
+				for (size_t i = 0; i < values.size(); i++) {
+					std::visit([this, row, i](const auto& val) {
+						Encode_Value(row, i, val);
+					}, values[i]);
+				}
+
+				return !mFailed;
+			}
+
+			template<typename Arg0, typename... Args>
+			void Encode_Values(std::byte* row, size_t idx, const Arg0& arg, const Args&... args) const {
+				Encode_Value(row, idx, arg);
+				if constexpr (sizeof...(Args) > 0) {
+					Encode_Values(row, idx + 1, args...);
+				}
+			}
+
+			// does the column hold values of a given count of rows? (the storage actually used by the column is checked)
+			static bool Holds_Rows(const Column_Batch::Column& col, size_t rows) {
+				if (col.type == NVar_Type::Numeric) {
+					return col.numbers.size() >= rows && (col.missing.empty() || col.missing.size() >= rows);
+				}
+				if (col.dictionary_encoded) {
+					return col.codes.size() >= rows && std::all_of(col.codes.begin(), col.codes.begin() + rows, [&col](uint32_t code) {
+						return code < col.dictionary.Size();
+					});
+				}
+				if (col.fields) {
+					return true;
+				}
+				if (col.offsets.size() < rows + 1 || col.offsets[rows] > col.bytes.size()) {
+					return false;
+				}
+				return std::is_sorted(col.offsets.begin(), col.offsets.begin() + rows + 1);
+			}
+
+		public:
+			Writer(size_t buffer_size = 4 * 1024 * 1024) : mBuffer(std::max<size_t>(buffer_size, 80)) {
+			}
+
+			virtual ~Writer() {
+				Close();
+			}
+
+			/**
+			 * Creates (or truncates) the given file for writing
+			 * Returns true on success, false on failure
+			 */
+			bool Open(const std::filesystem::path& path) {
+				mFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+				mBuffer_Used = 0;
+				mWritten = 0;
+				mHeaders_Written = false;
+				mFailed = !mFile.is_open();
+				return !mFailed;
+			}
+
+			/**
+			 * Writes the file headers and variable descriptors of a single dataset; this must be done prior to writing any rows
+			 * Returns NStatus::Ok on success, NStatus::Invalid_Variable if the dataset name or any variable cannot be represented in the XPT v5 format
+			 * or the variable names are not unique, or NStatus::Write_Error if the file is not open
+			 */
+			NStatus Write_Headers(std::string_view dataset_name, const std::vector<Variable_Definition>& variables, std::string_view dataset_label = {}) {
+
+				if (!mFile.is_open() || mHeaders_Written) {
+					return NStatus::Write_Error;
+				}
+
+				if (dataset_name.empty() || dataset_name.size() > 8 || dataset_label.size() > 40 || variables.size() > 9999) {
+					return NStatus::Invalid_Variable;
+				}
+
+				for (size_t i = 0; i < variables.size(); i++) {
+					const auto& var = variables[i];
+					const bool valid_length = (var.type == NVar_Type::Numeric)
+						? (var.length >= 3 && var.length <= 8)
+						: (var.type == NVar_Type::String && var.length >= 1 && var.length <= 200);
+
+					if (var.name.empty() || var.name.size() > 8 || var.label.size() > 40 || !valid_length) {
+						return NStatus::Invalid_Variable;
+					}
+
+					// the variables are looked up by name when reading, so the names must be unique
+					for (size_t j = 0; j < i; j++) {
+						if (variables[j].name == var.name) {
+							return NStatus::Invalid_Variable;
+						}
+					}
+				}
+
+				mVariables = variables;
+				mPositions.clear();
+				mRecord_Len = 0;
+				for (const auto& var : mVariables) {
+					mPositions.push_back(mRecord_Len);
+					mRecord_Len += var.length;
+				}
+
+				internal::Date_Time_Record now;
+				Fill_Date_Time(now);
+
+				Put_Header("LIBRARY HEADER RECORD");
+
+				internal::File_Header_Record file_header;
+				Put_String(file_header.sas_symbol[0], "SAS");
+				Put_String(file_header.sas_symbol[1], "SAS");
+				Put_String(file_header.saslib, "SASLIB");
+				Put_String(file_header.sasver, "9.4");
+				Put_String(file_header.sas_os, "xptlib");
+				Put_String(file_header.blanks, "");
+				file_header.created = now;
+				Put_Record(file_header);
+				Put_Record(now);
+
+				Put_Header("MEMBER  HEADER RECORD", "000000000000000001600000000140");
+				Put_Header("DSCRPTR HEADER RECORD");
+
+				internal::Member_Header_Record member_header;
+				Put_String(member_header.sas_symbol, "SAS");
+				Put_String(member_header.sas_dsname, dataset_name);
+				Put_String(member_header.sasdata, "SASDATA");
+				Put_String(member_header.sasver, "9.4");
+				Put_String(member_header.sas_osname, "xptlib");
+				Put_String(member_header.blanks, "");
+				member_header.created = now;
+				Put_Record(member_header);
+
+				internal::Member_Header_Record_2 member_header_2;
+				member_header_2.modified_at = now;
+				Put_String(member_header_2.padding, "");
+				Put_String(member_header_2.dslabel, dataset_label);
+				Put_String(member_header_2.dstype, "");
+				Put_Record(member_header_2);
+
+				char nums[31];
+				std::snprintf(nums, sizeof(nums), "000000%04zu00000000000000000000", mVariables.size());
+				Put_Header("NAMESTR HEADER RECORD", nums);
+
+				for (size_t i = 0; i < mVariables.size(); i++) {
+					const auto& var = mVariables[i];
+
+					internal::Namestr_Record_1 namestr1{};
+					namestr1.ntype = internal::To_Machine_Endian_Raw(static_cast<uint16_t>(var.type));
+					namestr1.nlng = internal::To_Machine_Endian_Raw(static_cast<uint16_t>(var.length));
+					namestr1.nvar0 = internal::To_Machine_Endian_Raw(static_cast<uint16_t>(i + 1));
+					Put_String(namestr1.nname, var.name);
+					Put_String(namestr1.nlabel, var.label);
+					Put_String(namestr1.nform, "");
+					Put_String(namestr1.niform, "");
+
+					internal::Namestr_Record_2 namestr2{};
+					namestr2.npos = internal::To_Machine_Endian_Raw(static_cast<int32_t>(mPositions[i]));
+
+					Put(&namestr1, sizeof(namestr1));
+					Put(&namestr2, sizeof(namestr2));
+				}
+				Put_Padding();
+
+				Put_Header("OBS     HEADER RECORD");
+
+				mHeaders_Written = true;
+				return mFailed ? NStatus::Write_Error : NStatus::Ok;
+			}
+
+			/**
+			 * Writes a single row given by a vector of values (one per variable); values not matching the variable type are converted
+			 * by the same rule set as when reading (std::stod or std::to_string)
+			 * Returns true on success, false on failure (the value count does not match the variable count, or an I/O error occurred)
+			 */
+			bool Write_Next(const std::vector<TValue>& values) {
+				return Write_Variant_Row(values);
+			}
+
+			bool Write_Next(const std::vector<TValue_View>& values) {
+				return Write_Variant_Row(values);
+			}
+
+			/**
+			 * Writes a single row given by parameters of known type (arithmetic or string-like), one per variable
+			 * Returns true on success, false on failure (an I/O error occurred)
+			 */
+			template<typename... Args>
+			bool Write_Next(const Args&... args) {
+				static_assert(sizeof...(Args) > 0, "At least one value must be given");
+
+				if (!mHeaders_Written || sizeof...(Args) != mVariables.size()) {
+					return false;
+				}
+
+				Encode_Values(Reserve(mRecord_Len), 0, args...);
+				return !mFailed;
+			}
+
+			/**
+			 * Writes all rows of the columnar batch; the batch columns must match the variables of the file in count, order and type
+			 * Numeric columns are encoded to IBM format in bulk. Of filtered batches (see File::Set_Filter), just the selected rows are written
+			 * Returns true on success, false on failure (the batch does not match the variables, its columns or selection do not cover
+			 * its row count, or an I/O error occurred); nothing is written of a batch which does not match
+			 */
+			bool Write_Batch(const Column_Batch& batch) {
+
+				if (!mHeaders_Written || batch.columns.size() != mVariables.size()) {
+					return false;
+				}
+				for (size_t i = 0; i < mVariables.size(); i++) {
+					if (batch.columns[i].type != mVariables[i].type || !Holds_Rows(batch.columns[i], batch.rows)) {
+						return false;
+					}
+				}
+				if (batch.filtered && std::any_of(batch.selection.begin(), batch.selection.end(), [&batch](uint32_t row) { return row >= batch.rows; })) {
+					return false;
+				}
+
+				if (mRecord_Len == 0) {
+					return true;
+				}
+
+				// encode the rows in chunks fitting the output buffer
+				const size_t chunk_rows = std::max<size_t>(mBuffer.size() / mRecord_Len, 1);
+				const size_t row_total = batch.Selected_Rows();
+
+				// index of the k-th written row in the batch
+				const auto row_at = [&batch](size_t k) {
+					return batch.filtered ? static_cast<size_t>(batch.selection[k]) : k;
+				};
+
+				for (size_t first = 0; first < row_total; first += chunk_rows) {
+
+					const size_t rows = std::min(chunk_rows, row_total - first);
+					std::byte* data = Reserve(rows * mRecord_Len);
+
+					for (size_t i = 0; i < mVariables.size(); i++) {
+
+						const auto& col = batch.columns[i];
+						const size_t length = mVariables[i].length;
+						std::byte* dst = data + mPositions[i];
+
+						if (col.type == NVar_Type::Numeric) {
+							constexpr size_t Chunk_Size = 256;
+							std::array<uint64_t, Chunk_Size> raw;
+							std::array<double, Chunk_Size> selected;
+
+							for (size_t r = 0; r < rows; r += Chunk_Size) {
+								const size_t cnt = std::min(Chunk_Size, rows - r);
+
+								// selected values are gathered first, so they are encoded in bulk as well
+								const double* values = col.numbers.data() + first + r;
+								if (batch.filtered) {
+									for (size_t j = 0; j < cnt; j++) {
+										selected[j] = col.numbers[row_at(first + r + j)];
+									}
+									values = selected.data();
+								}
+								internal::IEEEToIbm(values, raw.data(), cnt);
+								for (size_t j = 0; j < cnt; j++, dst += mRecord_Len) {
+									std::memcpy(dst, &raw[j], length);
+								}
+							}
+						}
+						else {
+							for (size_t r = 0; r < rows; r++, dst += mRecord_Len) {
+								Put_String(dst, col.String(row_at(first + r)), length);
+							}
+						}
+					}
+				}
+
+				return !mFailed;
+			}
+
+			/**
+			 * Finishes the file - pads the data to 80-byte boundary, flushes the buffer and closes the file
+			 * Returns true on success, false if an I/O error occurred at any time
+			 */
+			bool Close() {
+				if (!mFile.is_open()) {
+					return !mFailed;
+				}
+
+				if (mHeaders_Written) {
+					Put_Padding();
+				}
+				Flush();
+				mFile.close();
+				if (mFile.fail()) {
+					mFailed = true;
+				}
+
+				mHeaders_Written = false;
+				return !mFailed;
+			}
+	};
+
 }